@@ -0,0 +1,139 @@
+#pragma once
+
+#include <iostream>
+#include <type_traits>
+#include "../2Arrays/DynArray.hpp"
+#include "../Headers/CompilerConsts.hpp"
+
+// Fenwick tree (binary indexed tree) over n values, indexed from 0.
+// Cell i of the 1-based tree holds the sum of the lsb(i) values ending at i,
+// where lsb(i) is the lowest set bit of i. Point updates and prefix sums walk
+// O(log(n)) cells by adding or stripping lowest set bits.
+template <typename T>
+class FenwickTree {
+    static_assert(std::is_arithmetic<T>::value, "Values must be of an arithmetic type");
+
+public:
+    // n zeros
+    explicit FenwickTree(size_t len = 0) : n(len), tree(len + 1) {
+        tree.resize(n + 1);
+        for (size_t i = 0; i <= n; ++i) {
+            tree.data()[i] = T();
+        }
+    }
+
+    // O(n) build over a copy of the values
+    FenwickTree(const T* values, size_t len) : n(len), tree(len + 1) {
+        tree.resize(1);
+        tree.data()[0] = T();
+        tree.append(values, n);
+
+        build();
+    }
+
+    explicit FenwickTree(DynArray<T> const& values) : FenwickTree(values.data(), values.size()) {}
+
+    // O(n) build in the buffer of 'values', which is left empty. The values
+    // move up one cell for the unused cell 0, which only reallocates if the
+    // buffer has no room left.
+    explicit FenwickTree(DynArray<T>&& values) : n(values.size()), tree(std::move(values)) {
+        tree.insertAt(0, T());
+
+        build();
+    }
+
+    virtual ~FenwickTree() = default;
+
+    // Returns the number of values
+    size_t size() const noexcept {
+        return n;
+    }
+
+    // Add 'delta' to the value at 'i', takes O(log(n))
+    void add(size_t i, T delta) noexcept {
+        T* t = tree.data();
+        for (++i; i <= n; i += lsb(i)) {
+            t[i] += delta;
+        }
+    }
+
+    // Sum of the values in [0, i], takes O(log(n))
+    T prefixSum(size_t i) const noexcept {
+        const T* t = tree.data();
+
+        T sum = T();
+        for (++i; i; i -= lsb(i)) {
+            sum += t[i];
+        }
+
+        return sum;
+    }
+
+    // Sum of the values in [l, r]
+    T sum(size_t l, size_t r) const noexcept {
+        return l ? prefixSum(r) - prefixSum(l - 1) : prefixSum(r);
+    }
+
+    // The value at 'i'
+    T get(size_t i) const noexcept {
+        return sum(i, i);
+    }
+
+    void set(size_t i, T value) noexcept {
+        add(i, value - get(i));
+    }
+
+    // Smallest i such that prefixSum(i) >= prefix, or size() if there is none.
+    // Values must not be negative, so that prefix sums never decrease. Walks
+    // down the implicit tree in O(log(n)), one bit of the answer at a time.
+    size_t lowerBound(T prefix) const noexcept {
+        const T* t = tree.data();
+
+        size_t pos = 0;
+        size_t step = n ? (size_t)1 << floor_log2(n) : 0;
+
+        for (; step; step >>= 1) {
+            if (pos + step <= n && t[pos + step] < prefix) {
+                pos += step;
+                prefix -= t[pos];
+            }
+        }
+
+        return pos;
+    }
+
+private:
+    static size_t lsb(size_t i) noexcept {
+        return i & (~i + 1);
+    }
+
+    // O(n) construction over the tree: every cell pushes its sum to its parent,
+    // which comes later in the array and is thus not final yet
+    void build() noexcept {
+        T* t = tree.data();
+        for (size_t i = 1; i <= n; ++i) {
+            size_t parent = i + lsb(i);
+            if (parent <= n) t[parent] += t[i];
+        }
+    }
+
+    // The number of values
+    size_t n;
+
+    // 1-based tree, cell 0 is unused
+    DynArray<T> tree;
+};
+
+/*int main(void) {
+    long values[6] = {3, 4, -2, 7, 3, 11};
+    FenwickTree<long> ft(values, 6);
+
+    std::cout << ft.sum(1, 3) << std::endl;     // 9
+    ft.add(2, 5);
+    std::cout << ft.prefixSum(3) << std::endl;  // 17
+
+    long counts[5] = {2, 0, 3, 1, 4};
+    FenwickTree<long> freq(counts, 5);
+    std::cout << freq.lowerBound(5) << std::endl; // 2
+    return 0;
+}*/
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "FenwickTree.hpp"
+
+// Range updates and point queries. The tree holds the differences between
+// neighbouring values, so adding to [l, r] changes two differences and the
+// value at i is the prefix sum of the differences up to i.
+template <typename T>
+class RangeUpdateFenwickTree {
+public:
+    explicit RangeUpdateFenwickTree(size_t len = 0) : diff(len) {}
+
+    RangeUpdateFenwickTree(const T* values, size_t len) : diff(differences(values, len)) {}
+
+    explicit RangeUpdateFenwickTree(DynArray<T> const& values) :
+        RangeUpdateFenwickTree(values.data(), values.size()) {}
+
+    virtual ~RangeUpdateFenwickTree() = default;
+
+    // Returns the number of values
+    size_t size() const noexcept {
+        return diff.size();
+    }
+
+    // Add 'delta' to every value in [l, r], takes O(log(n))
+    void rangeAdd(size_t l, size_t r, T delta) noexcept {
+        diff.add(l, delta);
+        if (r + 1 < diff.size()) diff.add(r + 1, -delta);
+    }
+
+    // The value at 'i', takes O(log(n))
+    T get(size_t i) const noexcept {
+        return diff.prefixSum(i);
+    }
+
+private:
+    static FenwickTree<T> differences(const T* values, size_t len) {
+        DynArray<T> d(len + 1);
+        for (size_t i = 0; i < len; ++i) {
+            d.add(i ? values[i] - values[i - 1] : values[i]);
+        }
+
+        return FenwickTree<T>(std::move(d));
+    }
+
+    FenwickTree<T> diff;
+};
+
+// Range updates and range sums. With d the differences of the values,
+//   prefixSum(i) = sum of d[j] * (i + 1 - j) for j <= i
+//                = (i + 1) * sum of d[j] - sum of d[j] * j
+// so one tree keeps d[j] and the other d[j] * j.
+template <typename T>
+class RangeFenwickTree {
+public:
+    explicit RangeFenwickTree(size_t len = 0) : diff(len), weighted(len) {}
+
+    RangeFenwickTree(const T* values, size_t len) :
+        diff(differences(values, len, false)),
+        weighted(differences(values, len, true)) {}
+
+    explicit RangeFenwickTree(DynArray<T> const& values) :
+        RangeFenwickTree(values.data(), values.size()) {}
+
+    virtual ~RangeFenwickTree() = default;
+
+    // Returns the number of values
+    size_t size() const noexcept {
+        return diff.size();
+    }
+
+    // Add 'delta' to every value in [l, r], takes O(log(n))
+    void rangeAdd(size_t l, size_t r, T delta) noexcept {
+        diff.add(l, delta);
+        weighted.add(l, delta * (T)l);
+
+        if (r + 1 < diff.size()) {
+            diff.add(r + 1, -delta);
+            weighted.add(r + 1, -delta * (T)(r + 1));
+        }
+    }
+
+    // Sum of the values in [0, i], takes O(log(n))
+    T prefixSum(size_t i) const noexcept {
+        return diff.prefixSum(i) * (T)(i + 1) - weighted.prefixSum(i);
+    }
+
+    // Sum of the values in [l, r]
+    T sum(size_t l, size_t r) const noexcept {
+        return l ? prefixSum(r) - prefixSum(l - 1) : prefixSum(r);
+    }
+
+private:
+    static FenwickTree<T> differences(const T* values, size_t len, bool weightedByIndex) {
+        DynArray<T> d(len + 1);
+        for (size_t i = 0; i < len; ++i) {
+            T delta = i ? values[i] - values[i - 1] : values[i];
+            d.add(weightedByIndex ? delta * (T)i : delta);
+        }
+
+        return FenwickTree<T>(std::move(d));
+    }
+
+    FenwickTree<T> diff;
+    FenwickTree<T> weighted;
+};
+
+/*#include <chrono>
+#include <random>
+#include "../13SparseTables/SparseTable.hpp"
+
+// A stream of operations where a share of them are point updates and the rest
+// range sums, against a SparseTable rebuilt whenever a query follows updates
+void bench(size_t n, size_t ops, unsigned updatePercent) {
+    std::mt19937_64 rng(42);
+
+    DynArray<long> values(n);
+    for (size_t i = 0; i < n; ++i) values.add((long)(rng() % 1000));
+
+    DynArray<size_t> a(ops), b(ops);
+    DynArray<bool> isUpdate(ops);
+    for (size_t k = 0; k < ops; ++k) {
+        size_t l = rng() % n, r = rng() % n;
+        a.add(l < r ? l : r);
+        b.add(l < r ? r : l);
+        isUpdate.add(rng() % 100 < updatePercent);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    long sink = 0;
+    FenwickTree<long> ft(values);
+    for (size_t k = 0; k < ops; ++k) {
+        if (isUpdate.data()[k]) ft.add(a.data()[k], 1);
+        else sink += ft.sum(a.data()[k], b.data()[k]);
+    }
+
+    double fenwick = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+
+    bool stale = true;
+    std::unique_ptr<SparseTable<long>> st;
+    for (size_t k = 0; k < ops; ++k) {
+        if (isUpdate.data()[k]) {
+            values.data()[a.data()[k]] += 1;
+            stale = true;
+            continue;
+        }
+
+        if (stale) {
+            st = non_std::make_unique<SparseTable<long>>(values, STOperation::SUM, 1);
+            stale = false;
+        }
+
+        sink -= st->query(a.data()[k], b.data()[k]);
+    }
+
+    double rebuild = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << updatePercent << "% updates: FenwickTree " << fenwick * 1e3 << "ms, SparseTable rebuilds "
+              << rebuild * 1e3 << "ms (" << sink << ")" << std::endl;
+}
+
+int main(void) {
+    long values[5] = {1, 2, 3, 4, 5};
+
+    RangeFenwickTree<long> rft(values, 5);
+    rft.rangeAdd(1, 3, 10);
+    std::cout << rft.sum(0, 4) << " " << rft.sum(2, 2) << std::endl; // 45 13
+
+    RangeUpdateFenwickTree<long> ruft(values, 5);
+    ruft.rangeAdd(0, 2, -1);
+    std::cout << ruft.get(2) << " " << ruft.get(3) << std::endl;     // 2 4
+
+    for (unsigned percent : {1u, 10u, 50u, 90u}) {
+        bench(100000, 20000, percent);
+    }
+
+    return 0;
+}*/
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "SparseTable.hpp"
+
+// Range minimum (or maximum) queries in O(1) with O(n) memory.
+//
+// The values are cut into blocks of 64. A SparseTable answers queries over
+// whole blocks from the best value of each block, which takes O(n / 64 log(n))
+// cells. Inside a block, mask[i] records the monotonic stack left after
+// pushing the values of the block up to i: bit j is set if the value at j is
+// better than everything after it up to i. The answer for [l, i] within a
+// block is then the lowest set bit of mask[i] at or above l.
+//
+// Altogether that is a copy of the values plus one 64-bit mask per element.
+// 'Op' has to be selective and idempotent, such as MinOp or MaxOp; ties go to
+// the leftmost position, as with SparseTable.
+template <typename T, typename Op = MinOp>
+class BlockRMQ {
+    static_assert(range_ops_detail::idempotent<Op>::value && range_ops_detail::selective<Op>::value,
+                  "Op must be idempotent and selective");
+
+public:
+    BlockRMQ(const T* source, size_t len, Op operation = Op()) :
+        n(len),
+        op(operation),
+        values(non_std::make_unique<T[]>(len ? len : 1)),
+        mask(non_std::make_unique<uint64_t[]>(len ? len : 1))
+    {
+        if (!n) {
+            throw std::invalid_argument("Size must be natural");
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = source[i];
+        }
+
+        init();
+    }
+
+    BlockRMQ(DynArray<T> const& source, Op operation = Op()) :
+        BlockRMQ(source.data(), source.size(), operation) {}
+
+    BlockRMQ(BlockRMQ&&) = default;
+    BlockRMQ& operator=(BlockRMQ&&) = default;
+
+    virtual ~BlockRMQ() = default;
+
+    // Returns the number of values
+    size_t size() const noexcept {
+        return n;
+    }
+
+    T query(size_t l, size_t r) const noexcept {
+        return values[queryIndex(l, r)];
+    }
+
+    // Position of the answer, the leftmost one on ties
+    size_t queryIndex(size_t l, size_t r) const noexcept {
+        size_t first = l / BLOCK;
+        size_t last = r / BLOCK;
+
+        if (first == last) {
+            return inBlock(l, r);
+        }
+
+        size_t best = inBlock(l, first * BLOCK + BLOCK - 1);
+
+        if (first + 1 < last) {
+            size_t middle = blockBest[blocks->queryIndex(first + 1, last - 1)];
+            best = better(best, middle);
+        }
+
+        return better(best, inBlock(last * BLOCK, r));
+    }
+
+private:
+    static constexpr const size_t BLOCK = 64;
+
+    // Of two positions, the left one 'i' and the right one 'j'
+    size_t better(size_t i, size_t j) const noexcept {
+        return op(values[i], values[j]) == values[i] ? i : j;
+    }
+
+    // Answer for [l, r] within a single block
+    size_t inBlock(size_t l, size_t r) const noexcept {
+        size_t base = l & ~(BLOCK - 1);
+        uint64_t stack = mask[r] & (~0ULL << (l - base));
+
+        #if defined(__GNUC__) || defined(__clang__)
+        return base + __builtin_ctzll(stack);
+        #else
+        unsigned low = 0;
+        while (!(stack & (1ULL << low))) ++low;
+        return base + low;
+        #endif
+    }
+
+    void init() {
+        const T* v = values.get();
+        size_t numBlocks = (n + BLOCK - 1) / BLOCK;
+        blockBest = non_std::make_unique<size_t[]>(numBlocks);
+
+        DynArray<T> best(numBlocks);
+        for (size_t block = 0; block < numBlocks; ++block) {
+            size_t base = block * BLOCK;
+            size_t end = base + BLOCK < n ? base + BLOCK : n;
+
+            // Pop every value which is not better than the incoming one
+            uint64_t stack = 0;
+            for (size_t i = base; i < end; ++i) {
+                while (stack) {
+                    unsigned top = floor_log2(stack);
+                    if (op(v[base + top], v[i]) == v[base + top]) break;
+
+                    stack ^= 1ULL << top;
+                }
+
+                stack |= 1ULL << (i - base);
+                mask[i] = stack;
+            }
+
+            blockBest[block] = inBlock(base, end - 1);
+            best.add(v[blockBest[block]]);
+        }
+
+        blocks = non_std::make_unique<SparseTable<T, Op>>(best.data(), numBlocks, op, 1);
+
+        // Build the index table now rather than on the first query
+        blocks->queryIndex(0, 0);
+    }
+
+    // The number of values
+    size_t n;
+
+    Op op;
+
+    std::unique_ptr<T[]> values;
+
+    // Monotonic stack of the block of i, as it was after pushing i
+    std::unique_ptr<uint64_t[]> mask;
+
+    // Position of the best value of each block
+    std::unique_ptr<size_t[]> blockBest;
+
+    // Sparse table over the best value of each block
+    std::unique_ptr<SparseTable<T, Op>> blocks;
+};
+
+/*#include <chrono>
+#include <random>
+
+template <typename RMQ>
+void bench(const char* name, RMQ const& rmq, double megabytes, DynArray<size_t> const& ls, DynArray<size_t> const& rs) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t sink = 0;
+    for (size_t i = 0; i < ls.size(); ++i) {
+        sink += rmq.queryIndex(ls.data()[i], rs.data()[i]);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << megabytes << " MB, " << seconds / ls.size() * 1e9 << " ns/query (" << sink % 2 << ")" << std::endl;
+}
+
+int main(void) {
+    long values[7] = {1, 2, -3, 2, 4, -1, 5};
+    BlockRMQ<long> rmq(values, array_size(values));
+    std::cout << rmq.query(3, 6) << " at " << rmq.queryIndex(3, 6) << std::endl;
+
+    // The sparse table with its index table takes ~1.5 GB at this size
+    const size_t n = 1 << 22, q = 1 << 23;
+    const double levels = floor_log2(n) + 1;
+    std::mt19937_64 rng(42);
+
+    DynArray<long> v(n);
+    for (size_t i = 0; i < n; ++i) v.add((long)(rng() % 1000000));
+
+    DynArray<size_t> ls(q), rs(q);
+    for (size_t i = 0; i < q; ++i) {
+        size_t l = rng() % n, r = rng() % n;
+        ls.add(l < r ? l : r);
+        rs.add(l < r ? r : l);
+    }
+
+    // Values and masks, plus a sparse table over n / 64 blocks with its index table
+    double blockBytes = n * (sizeof(long) + sizeof(uint64_t)) + (n / 64.0) * (levels - 6) * (sizeof(long) + 2 * sizeof(size_t));
+    bench("BlockRMQ<long>", BlockRMQ<long>(v), blockBytes / (1 << 20), ls, rs);
+
+    // Every level holds about n cells, with the index table as large again
+    double tableBytes = n * levels * (sizeof(long) + sizeof(size_t));
+    bench("SparseTable<long, MinOp>", SparseTable<long, MinOp>(v), tableBytes / (1 << 20), ls, rs);
+    return 0;
+}*/
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "RangeOps.hpp"
+#include "../2Arrays/DynArray.hpp"
+#include "../Headers/CompilerConsts.hpp"
+#include "../Headers/NonSTD.hpp"
+
+// Range queries in O(1) with exactly one combine for any associative operation
+// 'Op' (see RangeOps.hpp), including ones which are neither idempotent nor
+// commutative: sums, products, modular products, matrix products, composition
+// of affine maps...
+//
+// Level k cuts the values into blocks of 2^(k+1). Within each block the cells
+// left of the middle hold the combine from there up to the middle, and the
+// cells right of it the combine from the middle up to there. A range [l, r]
+// with l != r straddles the middle of exactly one block, on the level of the
+// highest bit in which l and r differ, so it is the combine of two cells.
+// That takes n * ceil(log2(n)) cells.
+//
+// Invertible operations such as SumOp only keep the n prefixes instead, and
+// answer [l, r] with inverse(prefix[r], prefix[l - 1]). For floating point
+// sums this trades precision to cancellation for the smaller table.
+template <typename T, typename Op>
+class DisjointSparseTable {
+    using Invertible = std::integral_constant<bool, range_ops_detail::invertible<Op>::value>;
+
+public:
+    DisjointSparseTable(const T* values, size_t len, Op operation = Op()) : n(len), op(operation) {
+        if (!n) {
+            throw std::invalid_argument("Size must be natural");
+        }
+
+        init(values, Invertible());
+    }
+
+    DisjointSparseTable(DynArray<T> const& values, Op operation = Op()) :
+        DisjointSparseTable(values.data(), values.size(), operation) {}
+
+    DisjointSparseTable(DisjointSparseTable&&) = default;
+    DisjointSparseTable& operator=(DisjointSparseTable&&) = default;
+
+    virtual ~DisjointSparseTable() = default;
+
+    // Returns the number of values
+    size_t size() const noexcept {
+        return n;
+    }
+
+    // Combine of the values in [l, r], in order
+    T query(size_t l, size_t r) const {
+        return query(l, r, Invertible());
+    }
+
+private:
+    T query(size_t l, size_t r, std::true_type) const {
+        return l ? op.inverse(table[r], table[l - 1]) : table[r];
+    }
+
+    T query(size_t l, size_t r, std::false_type) const {
+        if (l == r) return table[l];
+
+        const T* level = table.get() + floor_log2(l ^ r) * n;
+        return op(level[l], level[r]);
+    }
+
+    void init(const T* v, std::true_type) {
+        table = non_std::make_unique<T[]>(n);
+
+        table[0] = v[0];
+        for (size_t i = 1; i < n; ++i) {
+            table[i] = op(table[i - 1], v[i]);
+        }
+    }
+
+    void init(const T* v, std::false_type) {
+        // Level 0 doubles as the values themselves, for l == r
+        unsigned levels = n > 1 ? floor_log2(n - 1) + 1 : 1;
+        table = non_std::make_unique<T[]>(levels * n);
+
+        for (size_t i = 0; i < n; ++i) {
+            table[i] = v[i];
+        }
+
+        for (unsigned k = 0; k < levels; ++k) {
+            T* level = table.get() + k * n;
+            size_t half = (size_t)1 << k;
+
+            for (size_t mid = half; mid < n; mid += 2 * half) {
+                // Suffixes of the left half, ending just before the middle
+                level[mid - 1] = v[mid - 1];
+                for (size_t i = mid - 1; i > mid - half; --i) {
+                    level[i - 1] = op(v[i - 1], level[i]);
+                }
+
+                // Prefixes of the right half, starting at the middle
+                size_t end = mid + half < n ? mid + half : n;
+                level[mid] = v[mid];
+                for (size_t i = mid + 1; i < end; ++i) {
+                    level[i] = op(level[i - 1], v[i]);
+                }
+            }
+        }
+    }
+
+    // The number of values
+    size_t n;
+
+    // Prefixes for invertible operations, levels one after another otherwise
+    std::unique_ptr<T[]> table;
+
+    Op op;
+};
+
+/*#include <chrono>
+#include <random>
+#include "SparseTable.hpp"
+
+// f(x) = a * x + b, composed so that (f, g) applies f first, modulo 10^9 + 7
+struct Affine {
+    long long a;
+    long long b;
+};
+
+struct ComposeOp {
+    static constexpr const bool idempotent = false;
+
+    Affine operator()(Affine f, Affine g) const noexcept {
+        const long long mod = 1000000007;
+        return Affine{g.a * f.a % mod, (g.a * f.b + g.b) % mod};
+    }
+};
+
+// SumOp without the prefix path
+struct PlainSumOp {
+    static constexpr const bool idempotent = false;
+
+    long operator()(long a, long b) const noexcept {
+        return a + b;
+    }
+};
+
+template <typename Table>
+void bench(const char* name, Table const& st, DynArray<size_t> const& ls, DynArray<size_t> const& rs) {
+    auto start = std::chrono::steady_clock::now();
+
+    long sink = 0;
+    for (size_t i = 0; i < ls.size(); ++i) {
+        sink += st.query(ls.data()[i], rs.data()[i]);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ls.size() / seconds / 1e6 << "M queries/s (" << sink % 2 << ")" << std::endl;
+}
+
+int main(void) {
+    Affine maps[4] = {{2, 1}, {3, 0}, {1, 5}, {4, 2}};
+    DisjointSparseTable<Affine, ComposeOp> compose(maps, array_size(maps));
+
+    Affine f = compose.query(1, 3);
+    std::cout << "x -> " << f.a << "x + " << f.b << std::endl; // x -> 12x + 22
+
+    const size_t n = 1 << 20, q = 1 << 24;
+    std::mt19937_64 rng(42);
+
+    DynArray<long> v(n);
+    for (size_t i = 0; i < n; ++i) v.add((long)(rng() % 1000000));
+
+    DynArray<size_t> ls(q), rs(q);
+    for (size_t i = 0; i < q; ++i) {
+        size_t l = rng() % n, r = rng() % n;
+        ls.add(l < r ? l : r);
+        rs.add(l < r ? r : l);
+    }
+
+    bench("SparseTable<long, SumOp>", SparseTable<long, SumOp>(v), ls, rs);
+    bench("DisjointSparseTable<long, PlainSumOp>", DisjointSparseTable<long, PlainSumOp>(v), ls, rs);
+    bench("DisjointSparseTable<long, SumOp>", DisjointSparseTable<long, SumOp>(v), ls, rs);
+    return 0;
+}*/
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include "BlockRMQ.hpp"
+#include "../7UnionFind/Edge.hpp"
+#include "../Headers/CompilerConsts.hpp"
+#include "../Headers/NonSTD.hpp"
+#include "../Headers/Parallel.hpp"
+
+// Lowest common ancestors on a static rooted tree of n nodes in O(1).
+//
+// The Euler tour lists the nodes in the order a depth first walk passes
+// through them, 2n - 1 entries in all. Between the first visits of u and v the
+// walk climbs no higher than their lowest common ancestor, and goes through
+// it, so the LCA is the shallowest entry in that stretch: a range minimum
+// query over the depths of the tour. 'RMQ' answers it with 'queryIndex' over
+// uint32_t depths, BlockRMQ takes O(n) memory and SparseTable<uint32_t, MinOp>
+// O(n log(n)).
+//
+// The walk keeps its own stack, so paths of millions of nodes are fine.
+template <typename RMQ = BlockRMQ<uint32_t, MinOp>>
+class LCA {
+public:
+    // parent[i] is the parent of node i, the root is its own parent
+    LCA(const size_t* parent, size_t len) : n(len) {
+        checkSize(len);
+
+        size_t root = n;
+        for (size_t i = 0; i < n; ++i) {
+            if (parent[i] >= n) {
+                throw std::invalid_argument("Parent out of range");
+            }
+
+            if (parent[i] == i) {
+                if (root != n) {
+                    throw std::invalid_argument("The tree must have exactly one root");
+                }
+
+                root = i;
+            }
+        }
+
+        if (root == n) {
+            throw std::invalid_argument("The tree must have exactly one root");
+        }
+
+        // Children of every node, grouped by parent
+        auto offset = non_std::make_unique<size_t[]>(n + 1);
+        auto children = non_std::make_unique<size_t[]>(n);
+
+        for (size_t i = 0; i <= n; ++i) offset[i] = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i != root) ++offset[parent[i] + 1];
+        }
+
+        for (size_t i = 0; i < n; ++i) offset[i + 1] += offset[i];
+        for (size_t i = 0; i < n; ++i) {
+            if (i != root) children[offset[parent[i]]++] = i;
+        }
+
+        // Each group ends where the next one starts, shift them back
+        for (size_t i = n; i; --i) offset[i] = offset[i - 1];
+        offset[0] = 0;
+
+        init(root, offset.get(), children.get(), false);
+    }
+
+    LCA(DynArray<size_t> const& parent) : LCA(parent.data(), parent.size()) {}
+
+    // The n - 1 edges of a tree over the nodes [0, n), rooted at 'root'
+    LCA(size_t len, const Edge* edges, size_t m, size_t root = 0) : n(len) {
+        checkSize(len);
+        if (m != n - 1 || root >= n) {
+            throw std::invalid_argument("A tree of n nodes has n - 1 edges");
+        }
+
+        // Both directions of every edge, grouped by node
+        auto offset = non_std::make_unique<size_t[]>(n + 1);
+        auto neighbours = non_std::make_unique<size_t[]>(m ? 2 * m : 1);
+
+        for (size_t i = 0; i <= n; ++i) offset[i] = 0;
+        for (size_t i = 0; i < m; ++i) {
+            if (edges[i].from >= n || edges[i].to >= n) {
+                throw std::invalid_argument("Edge out of range");
+            }
+
+            ++offset[edges[i].from + 1];
+            ++offset[edges[i].to + 1];
+        }
+
+        for (size_t i = 0; i < n; ++i) offset[i + 1] += offset[i];
+        for (size_t i = 0; i < m; ++i) {
+            neighbours[offset[edges[i].from]++] = edges[i].to;
+            neighbours[offset[edges[i].to]++] = edges[i].from;
+        }
+
+        for (size_t i = n; i; --i) offset[i] = offset[i - 1];
+        offset[0] = 0;
+
+        init(root, offset.get(), neighbours.get(), true);
+    }
+
+    LCA(LCA&&) = default;
+    LCA& operator=(LCA&&) = default;
+
+    virtual ~LCA() = default;
+
+    // Returns the number of nodes
+    size_t size() const noexcept {
+        return n;
+    }
+
+    size_t root() const noexcept {
+        return tour[0];
+    }
+
+    // Number of edges between 'u' and the root
+    size_t depth(size_t u) const noexcept {
+        return tourDepth[first[u]];
+    }
+
+    size_t lca(size_t u, size_t v) const noexcept {
+        size_t a = first[u], b = first[v];
+        if (a > b) std::swap(a, b);
+
+        return tour[rmq->queryIndex(a, b)];
+    }
+
+    // Number of edges on the path between 'u' and 'v'
+    size_t distance(size_t u, size_t v) const noexcept {
+        return depth(u) + depth(v) - 2 * depth(lca(u, v));
+    }
+
+    // Whether or not 'u' lies on the path from 'v' to the root, v included.
+    // The subtree of u is walked between its first and last visits.
+    bool isAncestor(size_t u, size_t v) const noexcept {
+        return first[u] <= first[v] && last[v] <= last[u];
+    }
+
+    // Answer the k independent queries lca(u[i], v[i]) into out[i]. The tour
+    // positions of a group of queries are all looked up and prefetched before
+    // any of them is answered, so their cache misses overlap. Large batches can
+    // be split over 'threads' threads.
+    void lcaBatch(const size_t* u, const size_t* v, size_t* out, size_t k, unsigned threads = 1) const {
+        if (threads > 1 && k >= PARALLEL_BATCH) {
+            non_std::parallel_for(0, k, threads, [&](size_t begin, size_t end) {
+                lcaBatch(u + begin, v + begin, out + begin, end - begin, 1);
+            });
+
+            return;
+        }
+
+        size_t lo[BATCH];
+        size_t hi[BATCH];
+
+        for (size_t base = 0; base < k; base += BATCH) {
+            size_t len = k - base < BATCH ? k - base : BATCH;
+
+            for (size_t i = 0; i < len; ++i) {
+                prefetch_read(first.get() + u[base + i]);
+                prefetch_read(first.get() + v[base + i]);
+            }
+
+            for (size_t i = 0; i < len; ++i) {
+                size_t a = first[u[base + i]], b = first[v[base + i]];
+                lo[i] = a < b ? a : b;
+                hi[i] = a < b ? b : a;
+            }
+
+            for (size_t i = 0; i < len; ++i) {
+                out[base + i] = tour[rmq->queryIndex(lo[i], hi[i])];
+            }
+        }
+    }
+
+private:
+    // Queries in flight per group of 'lcaBatch'
+    static constexpr const size_t BATCH = 32;
+
+    // Batches at least this long are worth splitting over threads
+    static constexpr const size_t PARALLEL_BATCH = (size_t)1 << 16;
+
+    static constexpr const size_t NONE = (size_t)-1;
+
+    static void checkSize(size_t len) {
+        if (!len) {
+            throw std::invalid_argument("Size must be natural");
+        }
+
+        if (len > UINT32_MAX) {
+            throw std::invalid_argument("Too many nodes for 32-bit depths");
+        }
+    }
+
+    // Walk the tree from 'root', where the nodes next to u are
+    // adjacent[offset[u], offset[u + 1]). When 'undirected' these include the
+    // parent, which is skipped, and a node reached twice means a cycle.
+    void init(size_t rootNode, const size_t* offset, const size_t* adjacent, bool undirected) {
+        size_t tourLength = 2 * n - 1;
+
+        tour = non_std::make_unique<size_t[]>(tourLength);
+        tourDepth = non_std::make_unique<uint32_t[]>(tourLength);
+        first = non_std::make_unique<size_t[]>(n);
+        last = non_std::make_unique<size_t[]>(n);
+
+        for (size_t i = 0; i < n; ++i) first[i] = NONE;
+
+        // The path from the root to the current node, with the position of
+        // the next neighbour to look at for every node on it
+        auto path = non_std::make_unique<size_t[]>(n);
+        auto next = non_std::make_unique<size_t[]>(n);
+
+        size_t top = 0, pos = 0;
+        path[0] = rootNode;
+        next[0] = offset[rootNode];
+        visit(rootNode, 0, pos++);
+
+        while (true) {
+            size_t u = path[top];
+
+            if (next[top] == offset[u + 1]) {
+                if (!top) break;
+
+                // Back up to the parent, which is visited again
+                --top;
+                visit(path[top], top, pos++);
+                continue;
+            }
+
+            size_t child = adjacent[next[top]++];
+            if (undirected && top && child == path[top - 1]) continue;
+
+            if (first[child] != NONE) {
+                throw std::invalid_argument("The edges contain a cycle");
+            }
+
+            ++top;
+            path[top] = child;
+            next[top] = offset[child];
+            visit(child, top, pos++);
+        }
+
+        if (pos != tourLength) {
+            throw std::invalid_argument("Not a tree: some nodes are not connected to the root");
+        }
+
+        rmq = non_std::make_unique<RMQ>(tourDepth.get(), tourLength, MinOp());
+
+        // Build any lazy part of the RMQ now, so that queries are only reads
+        rmq->queryIndex(0, 0);
+    }
+
+    void visit(size_t u, size_t depth, size_t pos) noexcept {
+        tour[pos] = u;
+        tourDepth[pos] = (uint32_t)depth;
+
+        if (first[u] == NONE) first[u] = pos;
+        last[u] = pos;
+    }
+
+    // The number of nodes
+    size_t n;
+
+    // The Euler tour, and the depth of each of its entries
+    std::unique_ptr<size_t[]> tour;
+    std::unique_ptr<uint32_t[]> tourDepth;
+
+    // First and last position of every node in the tour
+    std::unique_ptr<size_t[]> first;
+    std::unique_ptr<size_t[]> last;
+
+    std::unique_ptr<RMQ> rmq;
+};
+
+/*#include <chrono>
+#include <random>
+
+// Binary lifting, as used until now: up[j][u] is the 2^j-th ancestor of u
+class BinaryLifting {
+public:
+    BinaryLifting(const size_t* parent, size_t n) : levels(floor_log2(n) + 1), depth(n), up(levels * n) {
+        up.resize(levels * n);
+        depth.resize(n);
+
+        // Parents come before their children in the trees built below
+        for (size_t u = 0; u < n; ++u) {
+            up.data()[u] = parent[u];
+            depth.data()[u] = parent[u] == u ? 0 : depth.data()[parent[u]] + 1;
+        }
+
+        for (size_t j = 1; j < levels; ++j) {
+            for (size_t u = 0; u < n; ++u) {
+                up.data()[j * n + u] = up.data()[(j - 1) * n + up.data()[(j - 1) * n + u]];
+            }
+        }
+
+        size = n;
+    }
+
+    size_t lca(size_t u, size_t v) const noexcept {
+        const size_t* a = up.data();
+        const size_t* d = depth.data();
+        if (d[u] < d[v]) std::swap(u, v);
+
+        for (size_t j = levels; j--; ) {
+            if (d[u] - d[v] >= ((size_t)1 << j)) u = a[j * size + u];
+        }
+
+        if (u == v) return u;
+
+        for (size_t j = levels; j--; ) {
+            if (a[j * size + u] != a[j * size + v]) {
+                u = a[j * size + u];
+                v = a[j * size + v];
+            }
+        }
+
+        return a[u];
+    }
+
+private:
+    size_t levels;
+    size_t size;
+    DynArray<size_t> depth;
+    DynArray<size_t> up;
+};
+
+template <typename Engine>
+void bench(const char* name, Engine const& engine, DynArray<size_t> const& us, DynArray<size_t> const& vs) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t sink = 0;
+    for (size_t i = 0; i < us.size(); ++i) {
+        sink += engine.lca(us.data()[i], vs.data()[i]);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << seconds / us.size() * 1e9 << " ns/query (" << sink << ")" << std::endl;
+}
+
+int main(void) {
+    // 0 has the children 1 and 2, 1 has 3 and 4, 2 has 5
+    Edge edges[5] = {{0, 1}, {0, 2}, {1, 3}, {1, 4}, {2, 5}};
+    LCA<> small(6, edges, 5);
+    std::cout << small.lca(3, 4) << " " << small.lca(4, 5) << " " << small.distance(3, 5) << " "
+              << small.isAncestor(1, 4) << small.isAncestor(2, 4) << std::endl; // 1 0 4 10
+
+    const size_t n = 1 << 21, q = 1 << 22;
+    std::mt19937_64 rng(42);
+
+    DynArray<size_t> parent(n);
+    parent.add(0);
+    for (size_t u = 1; u < n; ++u) parent.add(rng() % u);
+
+    DynArray<size_t> us(q), vs(q), out(q);
+    out.resize(q);
+    for (size_t i = 0; i < q; ++i) {
+        us.add(rng() % n);
+        vs.add(rng() % n);
+    }
+
+    bench("BinaryLifting", BinaryLifting(parent.data(), n), us, vs);
+    bench("LCA<BlockRMQ>", LCA<>(parent), us, vs);
+    bench("LCA<SparseTable>", LCA<SparseTable<uint32_t, MinOp>>(parent), us, vs);
+
+    LCA<> lca(parent);
+    auto start = std::chrono::steady_clock::now();
+    lca.lcaBatch(us.data(), vs.data(), out.data(), q);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "LCA<BlockRMQ>::lcaBatch: " << seconds / q * 1e9 << " ns/query" << std::endl;
+
+    // A single path of n nodes, far deeper than a recursive walk could go
+    for (size_t u = 1; u < n; ++u) parent.data()[u] = u - 1;
+    LCA<> path(parent);
+    std::cout << "path: " << path.distance(0, n - 1) << " edges" << std::endl;
+    return 0;
+}*/
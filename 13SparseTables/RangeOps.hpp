@@ -0,0 +1,181 @@
+#pragma once
+
+#include <stdexcept>
+#include <type_traits>
+
+// Combine operations for the range query structures. An operation is any
+// functor with an associative 'T operator()(T, T) const', which may tell
+// through static members which shortcuts are allowed with it:
+//   idempotent  f(a, a) = a, so overlapping ranges can be combined.
+//               Functors which do not say are taken to be idempotent.
+//   selective   f(a, b) is always one of a or b, so the position of the
+//               answer can be tracked. False unless said otherwise.
+//   invertible  There is an 'inverse(whole, prefix)' member returning the x
+//               for which f(prefix, x) = whole, so ranges can be answered from
+//               prefixes alone. False unless said otherwise.
+
+struct MinOp {
+    static constexpr const bool idempotent = true;
+    static constexpr const bool selective = true;
+
+    // Ties go to the left argument
+    template <typename T>
+    T operator()(T a, T b) const noexcept {
+        return b < a ? b : a;
+    }
+};
+
+struct MaxOp {
+    static constexpr const bool idempotent = true;
+    static constexpr const bool selective = true;
+
+    // Ties go to the left argument
+    template <typename T>
+    T operator()(T a, T b) const noexcept {
+        return a < b ? b : a;
+    }
+};
+
+struct GcdOp {
+    static constexpr const bool idempotent = true;
+    static constexpr const bool selective = false;
+
+    template <typename T>
+    T operator()(T a, T b) const noexcept {
+        return gcd(a, b, std::is_integral<T>());
+    }
+
+private:
+    template <typename T>
+    static T gcd(T a, T b, std::true_type) noexcept {
+        while (b) {
+            T rest = a % b;
+            a = b;
+            b = rest;
+        }
+
+        return a > T() ? a : T() - a;
+    }
+
+    // Only reachable through DynamicOp, which rejects GCD for these types
+    template <typename T>
+    static T gcd(T a, T, std::false_type) noexcept {
+        return a;
+    }
+};
+
+struct SumOp {
+    static constexpr const bool idempotent = false;
+    static constexpr const bool selective = false;
+    static constexpr const bool invertible = true;
+
+    template <typename T>
+    T operator()(T a, T b) const noexcept {
+        return a + b;
+    }
+
+    template <typename T>
+    T inverse(T whole, T prefix) const noexcept {
+        return whole - prefix;
+    }
+};
+
+struct MulOp {
+    static constexpr const bool idempotent = false;
+    static constexpr const bool selective = false;
+
+    template <typename T>
+    T operator()(T a, T b) const noexcept {
+        return a * b;
+    }
+};
+
+enum class STOperation {
+    MIN,
+    MAX,
+    SUM,
+    MUL,
+    GCD
+};
+
+// Operation chosen at runtime, every combine goes through a switch
+template <typename T>
+class DynamicOp {
+public:
+    DynamicOp(STOperation operation) : op(operation) {
+        if (op == STOperation::GCD && !std::is_integral<T>::value) {
+            throw std::invalid_argument("GCD needs integral values");
+        }
+    }
+
+    T operator()(T a, T b) const noexcept {
+        switch (op) {
+            case STOperation::MIN: return MinOp()(a, b);
+            case STOperation::MAX: return MaxOp()(a, b);
+            case STOperation::SUM: return SumOp()(a, b);
+            case STOperation::MUL: return MulOp()(a, b);
+            case STOperation::GCD: return GcdOp()(a, b);
+        }
+
+        return a;
+    }
+
+    STOperation operation() const noexcept {
+        return op;
+    }
+
+private:
+    STOperation op;
+};
+
+namespace range_ops_detail {
+    template <typename...>
+    struct make_void { typedef void type; };
+
+    template <typename Op, typename = void>
+    struct idempotent : std::true_type {};
+
+    template <typename Op>
+    struct idempotent<Op, typename make_void<decltype(Op::idempotent)>::type> :
+        std::integral_constant<bool, Op::idempotent> {};
+
+    template <typename Op, typename = void>
+    struct selective : std::false_type {};
+
+    template <typename Op>
+    struct selective<Op, typename make_void<decltype(Op::selective)>::type> :
+        std::integral_constant<bool, Op::selective> {};
+
+    template <typename Op, typename = void>
+    struct invertible : std::false_type {};
+
+    template <typename Op>
+    struct invertible<Op, typename make_void<decltype(Op::invertible)>::type> :
+        std::integral_constant<bool, Op::invertible> {};
+}
+
+// Whether or not overlapping ranges may be combined with 'op'. Constant for
+// static operations, so branches on it fold away.
+template <typename Op>
+constexpr bool isIdempotent(Op const&) noexcept {
+    return range_ops_detail::idempotent<Op>::value;
+}
+
+template <typename T>
+bool isIdempotent(DynamicOp<T> const& op) noexcept {
+    return op.operation() == STOperation::MIN ||
+           op.operation() == STOperation::MAX ||
+           op.operation() == STOperation::GCD;
+}
+
+// Whether or not 'op' always answers with one of its arguments
+template <typename Op>
+constexpr bool isSelective(Op const&) noexcept {
+    return range_ops_detail::selective<Op>::value;
+}
+
+template <typename T>
+bool isSelective(DynamicOp<T> const& op) noexcept {
+    return op.operation() == STOperation::MIN ||
+           op.operation() == STOperation::MAX;
+}
@@ -1,205 +1,417 @@
 #pragma once
 
 #include <iostream>
-#include <functional>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include "RangeOps.hpp"
+#include "../2Arrays/DynArray.hpp"
 #include "../Headers/CompilerConsts.hpp"
- 
-enum class STOperation {
-    MIN,
-    MAX,
-    SUM,
-    MUL,
-    GCD
-};
-
-template <size_t n>
+#include "../Headers/NonSTD.hpp"
+#include "../Headers/Parallel.hpp"
+
+namespace non_std {
+    class Snapshot;
+}
+
+struct SparseTableSnapshot;
+
+// Sparse table over a runtime sized range of values of type 'T', combined
+// with the operation 'Op' (see RangeOps.hpp). Idempotent operations answer
+// queries in O(1) with one combine, the others in O(log(n)); for those,
+// DisjointSparseTable answers in O(1) as well.
+// Level i holds the answers for the n - 2^i + 1 ranges [j, j + 2^i), all
+// levels are stored back to back in one heap buffer. The index table used by
+// 'queryIndex' takes as much memory again, so it is only built on first use,
+// under a std::once_flag so that concurrent queries on a shared table are safe.
+// Every level is built from the one below it alone, each row is split over
+// 'threads' threads which write their own contiguous stretch of it front to
+// back, in a loop which vectorizes for MinOp and MaxOp.
+// A built table can be saved to a snapshot and loaded back by mapping it (see
+// SparseTableSnapshot.hpp), in which case queries read the levels straight
+// from the mapped file.
+template <typename T, typename Op = DynamicOp<T>>
 class SparseTable {
-    static_assert(n > 0, "Size must be natural");
-
-    // The maximum power of 2 needed. This value is floor(log2(n)) 
-    static constexpr const unsigned P = STATIC_LOG2(n);
+    static_assert(std::is_arithmetic<T>::value, "Values must be of an arithmetic type");
 
 public:
-    SparseTable(long (&values)[n], STOperation operation) noexcept {
-        op = operation;
+    SparseTable(const T* values, size_t len, Op operation = Op(),
+                unsigned threads = non_std::hardware_threads()) :
+        n(len),
+        buildThreads(threads),
+        op(operation)
+    {
+        if (!n) {
+            throw std::invalid_argument("Size must be natural");
+        }
+
         init(values);
     }
 
+    SparseTable(DynArray<T> const& values, Op operation = Op(),
+                unsigned threads = non_std::hardware_threads()) :
+        SparseTable(values.data(), values.size(), operation, threads) {}
+
+    SparseTable(SparseTable&&) = default;
+    SparseTable& operator=(SparseTable&&) = default;
+
     virtual ~SparseTable() = default;
 
-    long query(size_t l, size_t r) const noexcept {
-        switch (op) {
+    // Returns the number of values
+    size_t size() const noexcept {
+        return n;
+    }
+
+    T query(size_t l, size_t r) const noexcept {
+        if (isIdempotent(op)) {
             // O(1)
-            case STOperation::MIN: return query(l, r, minFn);
-            case STOperation::MAX: return query(l, r, maxFn);
-            case STOperation::GCD: return query(l, r, gcdFn);
+            unsigned p = log2[r - l + 1];
+            return op(level(p)[l], level(p)[r - ((size_t)1 << p) + 1]);
+        }
+
+        // O(log2(n))
+        return cascadeQuery(l, r);
+    }
 
-            // O(log2(n))
-            case STOperation::SUM: return sumQuery(l, r);
-            case STOperation::MUL: return mulQuery(l, r);
+    // Answer the k independent queries [l[i], r[i]] into out[i]. Queries are
+    // taken in groups whose cells are all located and prefetched before any of
+    // them is combined, so the cache misses of a group overlap instead of
+    // queueing up one query after another. Large batches can be split over
+    // 'threads' threads.
+    void queryBatch(const size_t* l, const size_t* r, T* out, size_t k, unsigned threads = 1) const {
+        if (threads > 1 && k >= PARALLEL_BATCH) {
+            non_std::parallel_for(0, k, threads, [&](size_t begin, size_t end) {
+                queryBatch(l + begin, r + begin, out + begin, end - begin, 1);
+            });
+
+            return;
+        }
+
+        if (!isIdempotent(op)) {
+            for (size_t i = 0; i < k; ++i) {
+                out[i] = cascadeQuery(l[i], r[i]);
+            }
+
+            return;
+        }
+
+        const T* leftCells[BATCH];
+        const T* rightCells[BATCH];
+
+        for (size_t base = 0; base < k; base += BATCH) {
+            size_t len = k - base < BATCH ? k - base : BATCH;
+
+            for (size_t i = 0; i < len; ++i) {
+                size_t lo = l[base + i];
+                size_t hi = r[base + i];
+                unsigned p = floor_log2(hi - lo + 1);
+
+                leftCells[i] = level(p) + lo;
+                rightCells[i] = level(p) + hi - ((size_t)1 << p) + 1;
+                prefetch_read(leftCells[i]);
+                prefetch_read(rightCells[i]);
+            }
+
+            for (size_t i = 0; i < len; ++i) {
+                out[base + i] = op(*leftCells[i], *rightCells[i]);
+            }
         }
     }
 
+    // Position of the answer, for selective operations such as MIN and MAX.
+    // The first call builds the index table in O(n log(n)), any others made
+    // meanwhile from other threads wait for it
     size_t queryIndex(size_t l, size_t r) const {
-        switch (op) {
-            case STOperation::MIN: return minQueryIndex(l, r);
-            case STOperation::MAX: return maxQueryIndex(l, r);
-            default: throw std::invalid_argument("Unsupported operation type");
+        if (!isSelective(op)) {
+            throw std::invalid_argument("Unsupported operation type");
         }
+
+        std::call_once(*indexOnce, [this]() { initIndex(); });
+
+        unsigned p = log2[r - l + 1];
+        size_t right = r - ((size_t)1 << p) + 1;
+
+        return choosesLeft(level(p)[l], level(p)[right]) ? indexLevel(p)[l] : indexLevel(p)[right];
     }
 
 private:
-    size_t minQueryIndex(size_t l, size_t r) const noexcept {
-        size_t len = r - l + 1;
-        unsigned p = log2[len];
-        long leftInterval = dp[p][l];
-        long rightInterval = dp[p][r - (1 << p) + 1];
-
-        if (leftInterval <= rightInterval) {
-            return it[p][l];
-        }
-        else {
-            return it[p][r - (1 << p) + 1];
-        }
-    }
+    friend struct SparseTableSnapshot;
 
-    size_t maxQueryIndex(size_t l, size_t r) const noexcept {
-        size_t len = r - l + 1;
-        unsigned p = log2[len];
-        long leftInterval = dp[p][l];
-        long rightInterval = dp[p][r - (1 << p) + 1];
+    // An empty table, for a loader to fill in
+    SparseTable(Op operation, unsigned threads) :
+        n(0),
+        buildThreads(threads),
+        op(operation) {}
 
-        if (leftInterval >= rightInterval) {
-            return it[p][l];
-        }
-        else {
-            return it[p][r - (1 << p) + 1];
-        }
+    // Queries in flight per group of 'queryBatch', about what the memory
+    // system can keep outstanding
+    static constexpr const size_t BATCH = 32;
+
+    // Batches smaller than this are not worth starting threads for
+    static constexpr const size_t PARALLEL_BATCH = 1 << 16;
+
+    // Neither are rows shorter than this
+    static constexpr const size_t PARALLEL_ROW = 1 << 16;
+
+    const T* level(unsigned p) const noexcept {
+        return dp + offset[p];
     }
 
-    long long sumQuery(size_t l, size_t r) const noexcept {
-        long long result = 0;
-        while (l <= r) {
-            unsigned p = log2[r - l + 1];
-            result += dp[p][l];
-            l += (1 << p);
-        }
+    const size_t* indexLevel(unsigned p) const noexcept {
+        return it.get() + offset[p];
+    }
 
-        return result;
+    bool choosesLeft(T leftInterval, T rightInterval) const noexcept {
+        return op(leftInterval, rightInterval) == leftInterval;
     }
 
-    long long mulQuery(size_t l, size_t r) const noexcept {
-        long long result = 1;
+    // Combine the disjoint power of 2 ranges which make up [l, r]
+    T cascadeQuery(size_t l, size_t r) const noexcept {
+        unsigned p = log2[r - l + 1];
+        T result = level(p)[l];
+        l += ((size_t)1 << p);
+
         while (l <= r) {
-            unsigned p = log2[r - l + 1];
-            result *= dp[p][l];
-            l += (1 << p);
+            p = log2[r - l + 1];
+            result = op(result, level(p)[l]);
+            l += ((size_t)1 << p);
         }
 
         return result;
     }
 
-    long query(size_t l, size_t r, std::function<long(long, long)> fn) const noexcept {
-        size_t len = r - l + 1;
-        unsigned p = log2[len];
-        return fn(dp[p][l], dp[p][r - (1 << p) + 1]);
-    }
+    // The number of values
+    size_t n;
+
+    // Threads used to build the table and the index table
+    unsigned buildThreads;
+
+    // The maximum power of 2 needed. This value is floor(log2(n))
+    unsigned P;
+
+    // Level i of the table starts at offset[i]
+    size_t offset[64];
 
     // Fast base 2 logarithm lookup table for 1 <= i <= n
-    unsigned log2[n + 1] = { 0 };
+    const uint8_t* log2 = nullptr;
 
     // The sparse table values.
-    long dp[P + 1][n];
-
-    // Index Table associated with the values in the sparse table.
-    size_t it[P + 1][n];
-
-    STOperation op;
-
-    std::function<long(long, long)> sumFn = [](long a, long b) -> long { return a + b; };
-    std::function<long(long, long)> minFn = [](long a, long b) -> long { return a < b ? a : b; };
-    std::function<long(long, long)> maxFn = [](long a, long b) -> long { return a > b ? a : b; };
-    std::function<long(long, long)> mulFn = [](long a, long b) -> long { return a * b; };
-    std::function<long(long, long)> gcdFn = [](long a, long b) -> long { 
-        long gcd = a;
-        while (b) {
-            gcd = b;
-            b = a % b;
-            a = gcd;
-        }
+    const T* dp = nullptr;
 
-        return (gcd ^ (gcd >> (sizeof(long) * 8 - 1))) - (gcd >> (sizeof(long) * 8 - 1));
-    };
+    // Storage of log2 and dp when the table was built rather than loaded
+    std::unique_ptr<uint8_t[]> ownedLog2;
+    std::unique_ptr<T[]> ownedDp;
+
+    // Mapped file of log2 and dp when the table was loaded
+    std::shared_ptr<non_std::Snapshot> snapshot;
+
+    // Index Table associated with the values in the sparse table, built lazily
+    mutable std::unique_ptr<size_t[]> it;
+
+    // Guards building 'it', on the heap since once flags cannot be moved
+    std::unique_ptr<std::once_flag> indexOnce = non_std::make_unique<std::once_flag>();
 
-    void init(long (&v)[n]) noexcept {
-        for (size_t i = 0; i < n; ++i) {
-            dp[0][i] = v[i];
-            it[0][i] = i;
+    Op op;
+
+    void layout() noexcept {
+        P = floor_log2(n);
+
+        offset[0] = 0;
+        for (unsigned i = 1; i <= P + 1; ++i) {
+            offset[i] = offset[i - 1] + (n - ((size_t)1 << (i - 1)) + 1);
         }
+    }
+
+    void init(const T* v) {
+        layout();
 
+        ownedLog2 = non_std::make_unique<uint8_t[]>(n + 1);
+        ownedDp = non_std::make_unique<T[]>(offset[P + 1]);
+        log2 = ownedLog2.get();
+        dp = ownedDp.get();
+
+        ownedLog2[0] = ownedLog2[1] = 0;
         for (size_t i = 2; i <= n; ++i) {
-            log2[i] = log2[i / 2] + 1;
+            ownedLog2[i] = ownedLog2[i / 2] + 1;
         }
 
+        T* row = ownedDp.get();
+        forEachChunk(n, [&](size_t begin, size_t end) {
+            std::copy(v + begin, v + end, row + begin);
+        });
+
         // Dynamic Programming: Build sparse table
         for (unsigned i = 1; i <= P; ++i) {
-            for (size_t j = 0; j + (1 << i) <= n; ++j) {
-                long leftInterval = dp[i - 1][j];
-                long rightInterval = dp[i - 1][j + (1 << (i - 1))];
-
-                switch (op) {
-                    case STOperation::MIN: {
-                        dp[i][j] = minFn(leftInterval, rightInterval);
-
-                        // Propagate the index of the best value
-                        if (leftInterval <= rightInterval) {
-                            it[i][j] = it[i - 1][j];
-                        }
-                        else {
-                            it[i][j] = it[i - 1][j + (1 << (i - 1))];
-                        }
-
-                        break;
-                    }
-
-                    case STOperation::MAX: {
-                        dp[i][j] = maxFn(leftInterval, rightInterval);
-
-                        // Propagate the index of the best value
-                        if (leftInterval >= rightInterval) {
-                            it[i][j] = it[i - 1][j];
-                        }
-                        else {
-                            it[i][j] = it[i - 1][j + (1 << (i - 1))];
-                        }
-
-                        break;
-                    }
-
-                    case STOperation::SUM: {
-                        dp[i][j] = sumFn(leftInterval, rightInterval);
-                        break;
-                    }
-
-                    case STOperation::MUL: {
-                        dp[i][j] = mulFn(leftInterval, rightInterval);
-                        break;
-                    }
-
-                    case STOperation::GCD: {
-                        dp[i][j] = gcdFn(leftInterval, rightInterval);
-                        break;
-                    }
-                }
+            const T* prev = dp + offset[i - 1];
+            T* cur = ownedDp.get() + offset[i];
+            size_t half = (size_t)1 << (i - 1);
+
+            forEachChunk(n - ((size_t)1 << i) + 1, [&](size_t begin, size_t end) {
+                combineRow(prev, prev + half, cur, begin, end);
+            });
+        }
+    }
+
+    // Split the cells [0, len) of a row over the threads, if it is worth it
+    template <typename Fn>
+    void forEachChunk(size_t len, Fn&& fn) const {
+        if (buildThreads > 1 && len >= PARALLEL_ROW) {
+            non_std::parallel_for(0, len, buildThreads, fn);
+        }
+        else {
+            fn(0, len);
+        }
+    }
+
+    // cur[j] = op(left[j], right[j]) for j in [begin, end), the rows never overlap
+    void combineRow(const T* left, const T* right, T* RESTRICT cur, size_t begin, size_t end) const noexcept {
+        Op combine = op;
+        for (size_t j = begin; j < end; ++j) {
+            cur[j] = combine(left[j], right[j]);
+        }
+    }
+
+    void initIndex() const {
+        it = non_std::make_unique<size_t[]>(offset[P + 1]);
+
+        size_t* row = it.get();
+        forEachChunk(n, [&](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) {
+                row[j] = j;
             }
+        });
+
+        for (unsigned i = 1; i <= P; ++i) {
+            const T* prev = dp + offset[i - 1];
+            const size_t* prevIndex = it.get() + offset[i - 1];
+            size_t* cur = it.get() + offset[i];
+            size_t half = (size_t)1 << (i - 1);
+
+            forEachChunk(n - ((size_t)1 << i) + 1, [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; ++j) {
+                    // Propagate the index of the best value
+                    cur[j] = choosesLeft(prev[j], prev[j + half]) ? prevIndex[j] : prevIndex[j + half];
+                }
+            });
         }
     }
 };
 
-/*int main(void) {
+// Table with the operation picked at runtime, as SparseTable was used before
+// operation policies. Every combine goes through a switch on 'operation'.
+template <typename T>
+SparseTable<T> makeSparseTable(const T* values, size_t n, STOperation operation) {
+    return SparseTable<T>(values, n, DynamicOp<T>(operation));
+}
+
+template <typename T>
+SparseTable<T> makeSparseTable(DynArray<T> const& values, STOperation operation) {
+    return SparseTable<T>(values, DynamicOp<T>(operation));
+}
+
+/*#include <chrono>
+#include <functional>
+#include <random>
+#include "SparseTableSnapshot.hpp"
+
+template <typename Table>
+void bench(const char* name, Table const& st, DynArray<size_t> const& ls, DynArray<size_t> const& rs) {
+    auto start = std::chrono::steady_clock::now();
+
+    long sink = 0;
+    for (size_t i = 0; i < ls.size(); ++i) {
+        sink += st.query(ls.data()[i], rs.data()[i]);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ls.size() / seconds / 1e6 << "M queries/s (" << sink % 2 << ")" << std::endl;
+}
+
+// Build times of the old per-cell dispatch against MinOp on 1 and all threads
+void benchBuild(size_t n) {
+    std::mt19937 rng(42);
+
+    DynArray<int32_t> v(n);
+    for (size_t i = 0; i < n; ++i) v.add((int32_t)rng());
+
+    auto time = [](std::function<void()> build) {
+        auto start = std::chrono::steady_clock::now();
+        build();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double dynamic = time([&]() { SparseTable<int32_t> st(v, STOperation::MIN, 1); });
+    double single = time([&]() { SparseTable<int32_t, MinOp> st(v, MinOp(), 1); });
+    double parallel = time([&]() { SparseTable<int32_t, MinOp> st(v); });
+
+    std::cout << "build n = " << n << ": STOperation " << dynamic << "s, MinOp " << single
+              << "s, MinOp on " << non_std::hardware_threads() << " threads " << parallel << "s" << std::endl;
+}
+
+// The combine behind a std::function, as the table called it before
+// operation policies
+struct FunctionOp {
+    std::function<long(long, long)> f;
+
+    long operator()(long a, long b) const {
+        return f(a, b);
+    }
+};
+
+// Pass 1 to also build 10^8 values, which takes ~11 GB
+int main(int argc, char** argv) {
+    benchBuild(1000000);
+    benchBuild(10000000);
+    if (argc > 1 && argv[1][0] == '1') benchBuild(100000000);
+
     long values[7] = {1, 2, -3, 2, 4, -1, 5};
-    SparseTable<array_size(values)> st(values, STOperation::MAX);
+    SparseTable<long, MaxOp> st(values, array_size(values));
+    std::cout << st.query(3, 6) << " at " << st.queryIndex(3, 6) << std::endl;
+
+    const size_t n = 1 << 20, q = 1 << 24;
+    std::mt19937_64 rng(42);
+
+    DynArray<long> v(n);
+    for (size_t i = 0; i < n; ++i) v.add((long)(rng() % 1000000));
+
+    DynArray<size_t> ls(q), rs(q);
+    for (size_t i = 0; i < q; ++i) {
+        size_t l = rng() % n, r = rng() % n;
+        ls.add(l < r ? l : r);
+        rs.add(l < r ? r : l);
+    }
+
+    bench("SparseTable<long, MinOp>", SparseTable<long, MinOp>(v), ls, rs);
+    bench("makeSparseTable(STOperation::MIN)", makeSparseTable(v, STOperation::MIN), ls, rs);
+    bench("SparseTable<long, FunctionOp> (std::function MIN)",
+          SparseTable<long, FunctionOp>(v, FunctionOp{[](long a, long b) { return b < a ? b : a; }}), ls, rs);
+    bench("SparseTable<long, GcdOp>", SparseTable<long, GcdOp>(v), ls, rs);
+    bench("makeSparseTable(STOperation::GCD)", makeSparseTable(v, STOperation::GCD), ls, rs);
+
+    SparseTable<long, MinOp> minTable(v);
+    DynArray<long> out(q);
+    out.resize(q);
+    std::fill(out.data(), out.data() + q, 0);
+
+    for (unsigned threads : {1u, 4u, non_std::hardware_threads()}) {
+        auto start = std::chrono::steady_clock::now();
+        minTable.queryBatch(ls.data(), rs.data(), out.data(), q, threads);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "queryBatch<MinOp>, " << threads << " thread(s): " << q / seconds / 1e6 << "M queries/s" << std::endl;
+    }
+
+    // Restart: map the saved table instead of building it again
+    saveSparseTable(minTable, "/tmp/sparse_table.snap");
+
+    auto start = std::chrono::steady_clock::now();
+    auto loaded = loadSparseTable<long, MinOp>("/tmp/sparse_table.snap", non_std::SnapshotCheck::BACKGROUND);
+    long first = loaded.query(ls.data()[0], rs.data()[0]);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "load + first query: " << seconds * 1e3 << "ms (" << first << "), checksum " << (verifySparseTable(loaded) ? "ok" : "bad") << std::endl;
 
-    std::cout << st.query(3, 6) << std::endl;
     return 0;
 }*/
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "RangeOps.hpp"
+#include "../2Arrays/DynArray.hpp"
+#include "../Headers/CompilerConsts.hpp"
+#include "../Headers/NonSTD.hpp"
+
+// Sparse table over a rows x cols matrix, answering idempotent queries such
+// as MinOp or MaxOp over any rectangle in O(1) with four cells.
+//
+// Plane (i, j) holds the answers for the rectangles of 2^i rows by 2^j columns,
+// for every top left corner from which one fits in the matrix. It is built
+// from plane (i, j - 1) along the columns when i = 0, and from plane (i - 1, j)
+// along the rows otherwise. Every plane is stored row-major and cropped to the
+// corners it has, and a query only ever reads from a single plane: the four
+// corner cells sit on two rows of it, in at most four cache lines.
+template <typename T, typename Op>
+class SparseTable2D {
+    static_assert(range_ops_detail::idempotent<Op>::value, "Op must be idempotent");
+
+public:
+    // 'values' is the matrix in row-major order
+    SparseTable2D(const T* values, size_t height, size_t width, Op operation = Op()) :
+        rows(height),
+        cols(width),
+        op(operation)
+    {
+        if (!rows || !cols) {
+            throw std::invalid_argument("Size must be natural");
+        }
+
+        init(values);
+    }
+
+    SparseTable2D(DynArray<T> const& values, size_t height, size_t width, Op operation = Op()) :
+        SparseTable2D(checked(values, height, width), height, width, operation) {}
+
+    SparseTable2D(SparseTable2D&&) = default;
+    SparseTable2D& operator=(SparseTable2D&&) = default;
+
+    virtual ~SparseTable2D() = default;
+
+    size_t numRows() const noexcept {
+        return rows;
+    }
+
+    size_t numCols() const noexcept {
+        return cols;
+    }
+
+    // Answer for the rectangle of rows [r1, r2] and columns [c1, c2]
+    T query(size_t r1, size_t c1, size_t r2, size_t c2) const noexcept {
+        unsigned i = floor_log2(r2 - r1 + 1);
+        unsigned j = floor_log2(c2 - c1 + 1);
+
+        const T* plane = table.get() + planeOffset[i * (PC + 1) + j];
+        size_t width = cols - ((size_t)1 << j) + 1;
+
+        const T* top = plane + r1 * width;
+        const T* bottom = plane + (r2 - ((size_t)1 << i) + 1) * width;
+        size_t right = c2 - ((size_t)1 << j) + 1;
+
+        return op(op(top[c1], top[right]), op(bottom[c1], bottom[right]));
+    }
+
+private:
+    static const T* checked(DynArray<T> const& values, size_t height, size_t width) {
+        if (values.size() != height * width) {
+            throw std::invalid_argument("Values do not match the dimensions");
+        }
+
+        return values.data();
+    }
+
+    void init(const T* values) {
+        PR = floor_log2(rows);
+        PC = floor_log2(cols);
+
+        planeOffset = non_std::make_unique<size_t[]>((PR + 1) * (PC + 1));
+
+        size_t total = 0;
+        for (unsigned i = 0; i <= PR; ++i) {
+            for (unsigned j = 0; j <= PC; ++j) {
+                planeOffset[i * (PC + 1) + j] = total;
+                total += (rows - ((size_t)1 << i) + 1) * (cols - ((size_t)1 << j) + 1);
+            }
+        }
+
+        table = non_std::make_unique<T[]>(total);
+
+        T* base = table.get();
+        for (size_t k = 0; k < rows * cols; ++k) {
+            base[k] = values[k];
+        }
+
+        for (unsigned i = 0; i <= PR; ++i) {
+            size_t height = rows - ((size_t)1 << i) + 1;
+
+            for (unsigned j = 0; j <= PC; ++j) {
+                if (!i && !j) continue;
+
+                size_t width = cols - ((size_t)1 << j) + 1;
+                T* plane = table.get() + planeOffset[i * (PC + 1) + j];
+
+                if (!i) {
+                    // Two halves side by side in plane (0, j - 1)
+                    const T* prev = table.get() + planeOffset[j - 1];
+                    size_t prevWidth = cols - ((size_t)1 << (j - 1)) + 1;
+                    size_t half = (size_t)1 << (j - 1);
+
+                    for (size_t r = 0; r < height; ++r) {
+                        const T* from = prev + r * prevWidth;
+                        T* to = plane + r * width;
+
+                        for (size_t c = 0; c < width; ++c) {
+                            to[c] = op(from[c], from[c + half]);
+                        }
+                    }
+                }
+                else {
+                    // Two halves one above the other in plane (i - 1, j)
+                    const T* prev = table.get() + planeOffset[(i - 1) * (PC + 1) + j];
+                    size_t half = (size_t)1 << (i - 1);
+
+                    for (size_t r = 0; r < height; ++r) {
+                        const T* upper = prev + r * width;
+                        const T* lower = prev + (r + half) * width;
+                        T* to = plane + r * width;
+
+                        for (size_t c = 0; c < width; ++c) {
+                            to[c] = op(upper[c], lower[c]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    size_t rows;
+    size_t cols;
+
+    // floor(log2()) of the number of rows and of columns
+    unsigned PR;
+    unsigned PC;
+
+    // Plane (i, j) starts at planeOffset[i * (PC + 1) + j]
+    std::unique_ptr<size_t[]> planeOffset;
+
+    std::unique_ptr<T[]> table;
+
+    Op op;
+};
+
+/*#include <chrono>
+#include <random>
+#include <vector>
+#include "SparseTable.hpp"
+
+int main(void) {
+    int tile[3 * 4] = {
+        5, 1, 7, 3,
+        2, 8, 0, 6,
+        9, 4, 2, 1
+    };
+
+    SparseTable2D<int, MinOp> small(tile, 3, 4);
+    std::cout << small.query(0, 2, 1, 3) << " " << small.query(1, 0, 2, 1) << std::endl; // 0 2
+
+    const size_t rows = 1024, cols = 1024, q = 1 << 22;
+    std::mt19937_64 rng(42);
+
+    DynArray<int> image(rows * cols);
+    for (size_t k = 0; k < rows * cols; ++k) image.add((int)(rng() % 256));
+
+    DynArray<size_t> corners(4 * q);
+    for (size_t k = 0; k < q; ++k) {
+        size_t r1 = rng() % rows, r2 = rng() % rows, c1 = rng() % cols, c2 = rng() % cols;
+        corners.add(r1 < r2 ? r1 : r2);
+        corners.add(c1 < c2 ? c1 : c2);
+        corners.add(r1 < r2 ? r2 : r1);
+        corners.add(c1 < c2 ? c2 : c1);
+    }
+
+    const size_t* c = corners.data();
+
+    SparseTable2D<int, MinOp> table(image, rows, cols);
+    auto start = std::chrono::steady_clock::now();
+
+    long sink = 0;
+    for (size_t k = 0; k < q; ++k) {
+        sink += table.query(c[4 * k], c[4 * k + 1], c[4 * k + 2], c[4 * k + 3]);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "SparseTable2D: " << seconds / q * 1e9 << " ns/query (" << sink << ")" << std::endl;
+
+    // One SparseTable per row, queried row by row
+    std::vector<SparseTable<int, MinOp>> perRow;
+    for (size_t r = 0; r < rows; ++r) perRow.emplace_back(image.data() + r * cols, cols, MinOp(), 1);
+
+    start = std::chrono::steady_clock::now();
+
+    sink = 0;
+    for (size_t k = 0; k < q; ++k) {
+        int best = perRow[c[4 * k]].query(c[4 * k + 1], c[4 * k + 3]);
+        for (size_t r = c[4 * k] + 1; r <= c[4 * k + 2]; ++r) {
+            best = MinOp()(best, perRow[r].query(c[4 * k + 1], c[4 * k + 3]));
+        }
+
+        sink += best;
+    }
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Per row SparseTable: " << seconds / q * 1e9 << " ns/query (" << sink << ")" << std::endl;
+    return 0;
+}*/
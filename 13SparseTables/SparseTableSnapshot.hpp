@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "SparseTable.hpp"
+#include "../Headers/Snapshot.hpp"
+
+// Snapshots of sparse tables, kept apart from SparseTable so that building
+// and querying tables does not depend on file mapping. This is the one place
+// allowed into a table's levels; use the free functions below.
+struct SparseTableSnapshot {
+    // Write the values, levels and operation to a snapshot file
+    template <typename T, typename Op>
+    static void save(SparseTable<T, Op> const& table, std::string const& path) {
+        static_assert(std::is_trivially_copyable<Op>::value, "Op must be trivially copyable to be saved");
+
+        Meta meta = {table.n, typeFlags<T>(), (uint32_t)sizeof(Op)};
+
+        non_std::SnapshotWriter writer(path, non_std::SnapshotKind::SPARSE_TABLE, sizeof(T));
+        writer.section(&meta, sizeof(meta));
+        writer.section(&table.op, sizeof(Op));
+        writer.section(table.log2, sizeof(uint8_t) * (table.n + 1));
+        writer.section(table.dp, sizeof(T) * table.offset[table.P + 1]);
+        writer.close();
+    }
+
+    // Map a table saved with the same T and Op, nothing is copied or rebuilt
+    template <typename T, typename Op>
+    static SparseTable<T, Op> load(std::string const& path, non_std::SnapshotCheck check, unsigned threads) {
+        auto source = std::make_shared<non_std::Snapshot>(path, non_std::SnapshotKind::SPARSE_TABLE, sizeof(T), check);
+
+        Meta const& meta = *source->section<Meta>(0, 1);
+        if (meta.flags != typeFlags<T>() || meta.opSize != sizeof(Op) || !meta.n) {
+            throw std::runtime_error("Snapshot holds a different structure");
+        }
+
+        SparseTable<T, Op> table(savedOp<Op>(*source), threads);
+        table.n = meta.n;
+        table.layout();
+
+        table.log2 = source->section<uint8_t>(2, table.n + 1);
+        table.dp = source->section<T>(3, table.offset[table.P + 1]);
+        table.snapshot = std::move(source);
+        return table;
+    }
+
+    // Whether or not the snapshot 'table' was loaded from is intact
+    template <typename T, typename Op>
+    static bool verify(SparseTable<T, Op> const& table) {
+        return table.snapshot ? table.snapshot->verify() : true;
+    }
+
+private:
+    struct Meta {
+        uint64_t n;
+        uint32_t flags;
+        uint32_t opSize;
+    };
+
+    template <typename T>
+    static uint32_t typeFlags() noexcept {
+        return (std::is_integral<T>::value ? 1 : 0) | (std::is_signed<T>::value ? 2 : 0);
+    }
+
+    // Operations are trivially copyable, so their bytes make a valid copy
+    template <typename Op>
+    static Op savedOp(non_std::Snapshot const& source) {
+        static_assert(std::is_trivially_copyable<Op>::value, "Op must be trivially copyable to be loaded");
+
+        typename std::aligned_storage<sizeof(Op), alignof(Op)>::type storage;
+        memcpy(&storage, source.section<unsigned char>(1, sizeof(Op)), sizeof(Op));
+        return *reinterpret_cast<Op*>(&storage);
+    }
+};
+
+template <typename T, typename Op>
+void saveSparseTable(SparseTable<T, Op> const& table, std::string const& path) {
+    SparseTableSnapshot::save(table, path);
+}
+
+// The checksum is computed as 'check' says, see verifySparseTable()
+template <typename T, typename Op = DynamicOp<T>>
+SparseTable<T, Op> loadSparseTable(std::string const& path,
+                                   non_std::SnapshotCheck check = non_std::SnapshotCheck::LAZY,
+                                   unsigned threads = non_std::hardware_threads()) {
+    return SparseTableSnapshot::load<T, Op>(path, check, threads);
+}
+
+template <typename T, typename Op>
+bool verifySparseTable(SparseTable<T, Op> const& table) {
+    return SparseTableSnapshot::verify(table);
+}
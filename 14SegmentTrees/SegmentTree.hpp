@@ -0,0 +1,534 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "../13SparseTables/RangeOps.hpp"
+#include "../2Arrays/DynArray.hpp"
+#include "../Headers/CompilerConsts.hpp"
+#include "../Headers/NonSTD.hpp"
+
+// Lazy tag for range assignments and range additions. A pending update is
+// either nothing, an addition or an assignment, and any sequence of them
+// collapses into one: an addition after an assignment is an assignment.
+//
+// Assignments work with every operation. Additions only distribute over
+// MinOp and MaxOp, which move by the amount added, and SumOp, which moves by
+// that amount times the number of values.
+template <typename T>
+class AssignAddTag {
+public:
+    enum class Kind : uint8_t {
+        NONE,
+        ADD,
+        ASSIGN
+    };
+
+    struct Update {
+        Kind kind;
+        T value;
+    };
+
+    static Update none() noexcept {
+        return {Kind::NONE, T()};
+    }
+
+    static Update add(T delta) noexcept {
+        return {Kind::ADD, delta};
+    }
+
+    static Update assign(T value) noexcept {
+        return {Kind::ASSIGN, value};
+    }
+
+    static bool empty(Update const& u) noexcept {
+        return u.kind == Kind::NONE;
+    }
+
+    // The update doing 'older' then 'newer'
+    static Update compose(Update const& older, Update const& newer) noexcept {
+        if (newer.kind != Kind::ADD || older.kind == Kind::NONE) {
+            return newer.kind == Kind::NONE ? older : newer;
+        }
+
+        return {older.kind, older.value + newer.value};
+    }
+
+    // Whether or not 'u' can be applied to aggregates of 'op'
+    template <typename Op>
+    static bool supports(Op const& op, Update const& u) noexcept {
+        return u.kind != Kind::ADD || addRule(op) != AddRule::NONE;
+    }
+
+    // Aggregate of 'len' values after 'u', given their aggregate before
+    template <typename Op>
+    static T apply(Op const& op, T aggregate, Update const& u, size_t len) noexcept {
+        switch (u.kind) {
+            case Kind::NONE: return aggregate;
+            case Kind::ADD: return addRule(op) == AddRule::SHIFT ? aggregate + u.value : aggregate + u.value * (T)len;
+            case Kind::ASSIGN: return repeat(op, u.value, len);
+        }
+
+        return aggregate;
+    }
+
+private:
+    // How an aggregate moves when every value moves by d
+    enum class AddRule {
+        NONE,   // It does not follow
+        SHIFT,  // By d
+        SCALE   // By d times the number of values
+    };
+
+    template <typename Op>
+    static AddRule addRule(Op const&) noexcept {
+        return AddRule::NONE;
+    }
+
+    static AddRule addRule(MinOp const&) noexcept {
+        return AddRule::SHIFT;
+    }
+
+    static AddRule addRule(MaxOp const&) noexcept {
+        return AddRule::SHIFT;
+    }
+
+    static AddRule addRule(SumOp const&) noexcept {
+        return AddRule::SCALE;
+    }
+
+    static AddRule addRule(DynamicOp<T> const& op) noexcept {
+        switch (op.operation()) {
+            case STOperation::MIN:
+            case STOperation::MAX: return AddRule::SHIFT;
+            case STOperation::SUM: return AddRule::SCALE;
+            default: return AddRule::NONE;
+        }
+    }
+
+    // Aggregate of 'len' copies of 'value'
+    template <typename Op>
+    static T repeat(Op const& op, T value, size_t len) noexcept {
+        if (len == 1) return value;
+        if (isIdempotent(op)) return op(value, value);
+        if (addRule(op) == AddRule::SCALE) return value * (T)len;
+
+        // Square and multiply, O(log(len)) combines
+        T result = value;
+        T power = value;
+        bool started = false;
+        for (; len; len >>= 1) {
+            if (len & 1) {
+                result = started ? op(result, power) : power;
+                started = true;
+            }
+
+            if (len > 1) power = op(power, power);
+        }
+
+        return result;
+    }
+};
+
+// Segment tree over a runtime sized range of values of type 'T', combined
+// with the operation 'Monoid' (see RangeOps.hpp) and updated over ranges
+// through the pending updates of 'LazyTag'. Queries and updates take
+// O(log(n)), with no recursion: the tree is a perfect binary tree over the
+// next power of 2 above n, stored as an implicit heap with the leaves at
+// [size, 2 * size), and both walk up from the two ends of the range.
+//
+// Only nodes which lie entirely inside [0, n) are ever read by a query, so the
+// leaves past n never need to be neutral for the operation. Pending updates
+// are pushed down the two boundary paths before every query, which is why
+// 'query' is const but not safe to call from several threads at once.
+template <typename T, typename Monoid = DynamicOp<T>, typename LazyTag = AssignAddTag<T>>
+class SegmentTree {
+    static_assert(std::is_arithmetic<T>::value, "Values must be of an arithmetic type");
+
+public:
+    typedef typename LazyTag::Update Update;
+
+    SegmentTree(const T* values, size_t len, Monoid operation = Monoid()) :
+        n(len),
+        op(operation)
+    {
+        if (!n) {
+            throw std::invalid_argument("Size must be natural");
+        }
+
+        init(values);
+    }
+
+    SegmentTree(DynArray<T> const& values, Monoid operation = Monoid()) :
+        SegmentTree(values.data(), values.size(), operation) {}
+
+    SegmentTree(SegmentTree&&) = default;
+    SegmentTree& operator=(SegmentTree&&) = default;
+
+    virtual ~SegmentTree() = default;
+
+    // Returns the number of values
+    size_t size() const noexcept {
+        return n;
+    }
+
+    // Answer for [l, r]
+    T query(size_t l, size_t r) const noexcept {
+        l += leaves;
+        r += leaves + 1;
+        pushBoundaries(l, r);
+
+        bool hasLeft = false, hasRight = false;
+        T left = T(), right = T();
+
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) {
+                left = hasLeft ? op(left, tree[l]) : tree[l];
+                hasLeft = true;
+                ++l;
+            }
+
+            if (r & 1) {
+                --r;
+                right = hasRight ? op(tree[r], right) : tree[r];
+                hasRight = true;
+            }
+        }
+
+        if (!hasRight) return left;
+        if (!hasLeft) return right;
+
+        return op(left, right);
+    }
+
+    // Position of the answer, for selective operations such as MIN and MAX.
+    // The leftmost one on ties, as with SparseTable.
+    size_t queryIndex(size_t l, size_t r) const {
+        if (!isSelective(op)) {
+            throw std::invalid_argument("Unsupported operation type");
+        }
+
+        l += leaves;
+        r += leaves + 1;
+        pushBoundaries(l, r);
+
+        // The nodes making up [l, r], from left to right
+        size_t nodes[2 * 64];
+        size_t front = 0, back = 2 * 64;
+
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) nodes[front++] = l++;
+            if (r & 1) nodes[--back] = --r;
+        }
+
+        size_t best = front ? nodes[0] : nodes[back];
+        for (size_t i = 1; i < front; ++i) {
+            if (!choosesLeft(tree[best], tree[nodes[i]])) best = nodes[i];
+        }
+
+        for (size_t i = front ? back : back + 1; i < 2 * 64; ++i) {
+            if (!choosesLeft(tree[best], tree[nodes[i]])) best = nodes[i];
+        }
+
+        // Down to the leaf holding it
+        while (best < leaves) {
+            push(best);
+            best = choosesLeft(tree[2 * best], tree[2 * best + 1]) ? 2 * best : 2 * best + 1;
+        }
+
+        return best - leaves;
+    }
+
+    // The value at 'i'
+    T get(size_t i) const noexcept {
+        i += leaves;
+        for (unsigned h = height; h; --h) {
+            push(i >> h);
+        }
+
+        return tree[i];
+    }
+
+    void set(size_t i, T value) noexcept {
+        i += leaves;
+        for (unsigned h = height; h; --h) {
+            push(i >> h);
+        }
+
+        tree[i] = value;
+        for (unsigned h = 1; h <= height; ++h) {
+            pull(i >> h);
+        }
+    }
+
+    void rangeAdd(size_t l, size_t r, T delta) {
+        update(l, r, LazyTag::add(delta));
+    }
+
+    void rangeAssign(size_t l, size_t r, T value) {
+        update(l, r, LazyTag::assign(value));
+    }
+
+    // Apply 'u' to every value in [l, r], takes O(log(n))
+    void update(size_t l, size_t r, Update const& u) {
+        check(u);
+
+        l += leaves;
+        r += leaves + 1;
+        pushBoundaries(l, r);
+        applyRange(l, r, u);
+
+        for (unsigned h = 1; h <= height; ++h) {
+            if (((l >> h) << h) != l) pull(l >> h);
+            if (((r >> h) << h) != r) pull((r - 1) >> h);
+        }
+    }
+
+    // Apply the k updates u[i] over [l[i], r[i]], in order. Small batches go
+    // one update at a time. Once the batch would recompute more nodes than the
+    // tree has, the updates only tag their nodes and every node is recomputed
+    // once at the end instead, in O(n).
+    void updateBatch(const size_t* l, const size_t* r, const Update* u, size_t k) {
+        if (k * 2 * height < leaves) {
+            for (size_t i = 0; i < k; ++i) {
+                update(l[i], r[i], u[i]);
+            }
+
+            return;
+        }
+
+        for (size_t i = 0; i < k; ++i) {
+            check(u[i]);
+        }
+
+        // Nodes above the updated ones are left stale, and pushing a tag into
+        // a stale node only makes it stale differently
+        for (size_t i = 0; i < k; ++i) {
+            size_t lo = l[i] + leaves;
+            size_t hi = r[i] + leaves + 1;
+
+            pushBoundaries(lo, hi);
+            applyRange(lo, hi, u[i]);
+        }
+
+        for (size_t node = leaves - 1; node; --node) {
+            pull(node);
+        }
+    }
+
+private:
+    void init(const T* values) {
+        height = n > 1 ? floor_log2(n - 1) + 1 : 0;
+        leaves = (size_t)1 << height;
+
+        tree = non_std::make_unique<T[]>(2 * leaves);
+        pending = non_std::make_unique<Update[]>(leaves);
+
+        for (size_t i = 0; i < n; ++i) {
+            tree[leaves + i] = values[i];
+        }
+
+        for (size_t i = n; i < leaves; ++i) {
+            tree[leaves + i] = T();
+        }
+
+        for (size_t node = 0; node < leaves; ++node) {
+            pending[node] = LazyTag::none();
+        }
+
+        for (size_t node = leaves - 1; node; --node) {
+            tree[node] = op(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+    void check(Update const& u) const {
+        if (!LazyTag::supports(op, u)) {
+            throw std::invalid_argument("Unsupported update for the operation type");
+        }
+    }
+
+    bool choosesLeft(T leftInterval, T rightInterval) const noexcept {
+        return op(leftInterval, rightInterval) == leftInterval;
+    }
+
+    // Number of leaves under 'node'
+    size_t width(size_t node) const noexcept {
+        return leaves >> floor_log2(node);
+    }
+
+    void applyNode(size_t node, Update const& u) const noexcept {
+        tree[node] = LazyTag::apply(op, tree[node], u, width(node));
+        if (node < leaves) pending[node] = LazyTag::compose(pending[node], u);
+    }
+
+    // Hand the pending update of 'node' to its children
+    void push(size_t node) const noexcept {
+        if (LazyTag::empty(pending[node])) return;
+
+        applyNode(2 * node, pending[node]);
+        applyNode(2 * node + 1, pending[node]);
+        pending[node] = LazyTag::none();
+    }
+
+    // Recompute 'node' from its children, and whatever is still pending on it
+    void pull(size_t node) const noexcept {
+        tree[node] = op(tree[2 * node], tree[2 * node + 1]);
+        if (!LazyTag::empty(pending[node])) {
+            tree[node] = LazyTag::apply(op, tree[node], pending[node], width(node));
+        }
+    }
+
+    // Push down the paths above the leaves 'l' and 'r - 1', top to bottom,
+    // skipping the nodes which are entirely inside [l, r)
+    void pushBoundaries(size_t l, size_t r) const noexcept {
+        for (unsigned h = height; h; --h) {
+            if (((l >> h) << h) != l) push(l >> h);
+            if (((r >> h) << h) != r) push((r - 1) >> h);
+        }
+    }
+
+    // Tag the nodes making up [l, r)
+    void applyRange(size_t l, size_t r, Update const& u) const noexcept {
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) applyNode(l++, u);
+            if (r & 1) applyNode(--r, u);
+        }
+    }
+
+    // The number of values
+    size_t n;
+
+    // Levels under the root, and the number of leaves 2^height
+    unsigned height;
+    size_t leaves;
+
+    Monoid op;
+
+    // Node i has children 2i and 2i + 1, leaf i is node leaves + i
+    mutable std::unique_ptr<T[]> tree;
+
+    // Update pending on the children of each inner node
+    mutable std::unique_ptr<Update[]> pending;
+};
+
+/*#include <chrono>
+#include <random>
+#include "../13SparseTables/SparseTable.hpp"
+
+// Rounds of 'updates' range additions followed by 'queries' range minimums,
+// against a SparseTable rebuilt after every round
+void bench(size_t n, size_t rounds, size_t updates, size_t queries) {
+    std::mt19937_64 rng(42);
+
+    DynArray<long> values(n);
+    for (size_t i = 0; i < n; ++i) values.add((long)(rng() % 1000000));
+
+    size_t total = rounds * (updates + queries);
+    DynArray<size_t> ls(total), rs(total);
+    DynArray<long> deltas(total);
+    for (size_t k = 0; k < total; ++k) {
+        size_t l = rng() % n, r = rng() % n;
+        ls.add(l < r ? l : r);
+        rs.add(l < r ? r : l);
+        deltas.add((long)(rng() % 201) - 100);
+    }
+
+    const size_t* l = ls.data();
+    const size_t* r = rs.data();
+    const long* d = deltas.data();
+
+    auto start = std::chrono::steady_clock::now();
+
+    long sink = 0;
+    SegmentTree<long, MinOp> tree(values);
+    for (size_t round = 0, k = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < updates; ++i, ++k) tree.rangeAdd(l[k], r[k], d[k]);
+        for (size_t i = 0; i < queries; ++i, ++k) sink += tree.query(l[k], r[k]);
+    }
+
+    double segment = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+
+    // The updates are spread over the values with a difference array first,
+    // which is as cheap as a rebuild can be made
+    DynArray<long> diff(n + 1);
+    diff.resize(n + 1);
+    for (size_t round = 0, k = 0; round < rounds; ++round) {
+        for (size_t i = 0; i <= n; ++i) diff.data()[i] = 0;
+        for (size_t i = 0; i < updates; ++i, ++k) {
+            diff.data()[l[k]] += d[k];
+            diff.data()[r[k] + 1] -= d[k];
+        }
+
+        long shift = 0;
+        for (size_t i = 0; i < n; ++i) {
+            shift += diff.data()[i];
+            values.data()[i] += shift;
+        }
+
+        SparseTable<long, MinOp> table(values, MinOp(), 1);
+        for (size_t i = 0; i < queries; ++i, ++k) sink -= table.query(l[k], r[k]);
+    }
+
+    double rebuild = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "n = " << n << ", " << rounds << " rounds of " << updates << " updates and " << queries
+              << " queries: SegmentTree " << segment * 1e3 << "ms, SparseTable rebuilds " << rebuild * 1e3
+              << "ms (" << sink << ")" << std::endl;
+}
+
+// The same range assignments one at a time and as one batch
+void benchBatch(size_t n, size_t k) {
+    typedef AssignAddTag<long> Tag;
+    std::mt19937_64 rng(7);
+
+    DynArray<long> values(n);
+    for (size_t i = 0; i < n; ++i) values.add((long)(rng() % 1000));
+
+    DynArray<size_t> ls(k), rs(k);
+    DynArray<Tag::Update> us(k);
+    for (size_t i = 0; i < k; ++i) {
+        size_t l = rng() % n, r = rng() % n;
+        ls.add(l < r ? l : r);
+        rs.add(l < r ? r : l);
+        us.add(i % 2 ? Tag::add((long)(rng() % 10)) : Tag::assign((long)(rng() % 1000)));
+    }
+
+    SegmentTree<long, SumOp> one(values), batch(values);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < k; ++i) one.update(ls.data()[i], rs.data()[i], us.data()[i]);
+    double sequential = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    batch.updateBatch(ls.data(), rs.data(), us.data(), k);
+    double batched = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << k << " updates on " << n << " sums: one by one " << sequential * 1e3 << "ms, updateBatch "
+              << batched * 1e3 << "ms (" << one.query(0, n - 1) - batch.query(0, n - 1) << ")" << std::endl;
+}
+
+int main(void) {
+    long values[7] = {1, 2, -3, 2, 4, -1, 5};
+
+    SegmentTree<long> st(values, array_size(values), STOperation::MIN);
+    st.rangeAdd(0, 3, 10);
+    std::cout << st.query(0, 6) << " at " << st.queryIndex(0, 6) << std::endl; // -1 at 5
+    st.rangeAssign(4, 6, 20);
+    std::cout << st.query(0, 6) << " at " << st.queryIndex(0, 6) << std::endl; // 7 at 2
+
+    SegmentTree<long, SumOp> sums(values, array_size(values));
+    sums.rangeAssign(1, 4, 3);
+    sums.rangeAdd(3, 6, 1);
+    std::cout << sums.query(0, 6) << std::endl;                                 // 21
+
+    const size_t n = 1 << 20;
+    bench(n, 100, 1, 10000);
+    bench(n, 100, 100, 1000);
+    bench(n, 100, 1000, 100);
+
+    benchBatch(n, 1 << 12);
+    benchBatch(n, 1 << 20);
+    return 0;
+}*/
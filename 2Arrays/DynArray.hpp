@@ -4,6 +4,7 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <cstring>
 #include "../Headers/Functional.hpp"
 #include "../Headers/NonSTD.hpp"
 
@@ -36,18 +37,33 @@ public:
         return *this;
     }
 
-    DynArray(DynArray&& source) noexcept {
-        if (!source.size()) {
-            internal_reserve(1);
-        }
-        else {
-            append(source.data(), source.size(), true);
-        }
+    // Takes over the buffer of 'source', which is left empty without one.
+    // It stays fully usable: the next add, append, insertAt, resize or
+    // reserve allocates a new buffer.
+    DynArray(DynArray&& source) noexcept :
+        m_size(source.m_size),
+        m_capacity(source.m_capacity),
+        m_buffer(source.m_buffer)
+    {
+        source.m_size = 0;
+        source.m_capacity = 0;
+        source.m_buffer = nullptr;
     }
 
     DynArray& operator=(DynArray&& source) noexcept {
-        clear();
-        append(source.data(), source.size(), true);
+        if (std::addressof(*this) != std::addressof(source)) {
+            clear();
+            free(m_buffer);
+
+            m_size = source.m_size;
+            m_capacity = source.m_capacity;
+            m_buffer = source.m_buffer;
+
+            source.m_size = 0;
+            source.m_capacity = 0;
+            source.m_buffer = nullptr;
+        }
+
         return *this;
     }
 
@@ -77,6 +93,14 @@ public:
         return m_buffer[index];
     }
 
+    T const& operator[](size_t index) const {
+        if (index >= m_size) {
+            throw std::out_of_range("Out of range");
+        }
+
+        return m_buffer[index];
+    }
+
     Maybe<T> at(size_t index) const noexcept {
         if (index >= m_size) {
             return Maybe<T>();
@@ -86,20 +110,24 @@ public:
     }
 
     void add(T const& val) {
-        resize(m_size + 1);
-        m_buffer[m_size - 1] = val;
+        // Grow geometrically, so that n consecutive adds take amortized O(n)
+        if (m_size == m_capacity) {
+            internal_reserve(m_capacity ? 2 * m_capacity : 1);
+        }
+
+        m_buffer[m_size++] = val;
     }
 
     void append(const T* data, size_t len, bool move_allowed = false) {
         if (!len) return;
 
         uint64_t this_range_start = (uintptr_t)m_buffer;
-        uint64_t this_range_end = this_range_start + m_size;
+        uint64_t this_range_end = this_range_start + sizeof(T) * m_size;
         uint64_t buffer_range_start = (uintptr_t)data;
-        uint64_t buffer_range_end = buffer_range_start + len;
+        uint64_t buffer_range_end = buffer_range_start + sizeof(T) * len;
 
-        if (this_range_end >= buffer_range_start &&
-            this_range_start <= buffer_range_end) {
+        if (this_range_end > buffer_range_start &&
+            this_range_start < buffer_range_end) {
 
             return;
         }
@@ -109,10 +137,10 @@ public:
         resize(new_pos);
 
         if (move_allowed) {
-            memmove(m_buffer + pos, data, len);
+            memmove(m_buffer + pos, data, sizeof(T) * len);
         }
         else {
-            memcpy(m_buffer + pos, data, len);
+            memcpy(m_buffer + pos, data, sizeof(T) * len);
         }
     }
 
@@ -217,7 +245,51 @@ private:
     T* m_buffer = nullptr;
 };
 
-/*int main(void) {
+template <>
+struct Functor<DynArray> {
+    template <typename Fn, typename A>
+    static DynArray<functional_detail::result_t<Fn, A const&>> fmap(Fn&& f, DynArray<A> const& v) {
+        typedef functional_detail::result_t<Fn, A const&> B;
+
+        size_t n = v.size();
+        DynArray<B> result(n);
+        result.resize(n);
+
+        const A* from = v.data();
+        B* to = result.data();
+        for (size_t i = 0; i < n; ++i) {
+            to[i] = f(from[i]);
+        }
+
+        return result;
+    }
+
+    // An array about to be dropped is mapped over in place when f maps A to A
+    template <typename Fn, typename A>
+    static auto fmap(Fn&& f, DynArray<A>&& v)
+        -> typename std::enable_if<std::is_same<functional_detail::result_t<Fn, A&&>, A>::value, DynArray<A>>::type {
+
+        A* data = v.data();
+        for (size_t i = 0, n = v.size(); i < n; ++i) {
+            data[i] = f(std::move(data[i]));
+        }
+
+        return std::move(v);
+    }
+
+    template <typename Fn, typename A>
+    static auto fmap(Fn&& f, DynArray<A>&& v)
+        -> typename std::enable_if<!std::is_same<functional_detail::result_t<Fn, A&&>, A>::value,
+                                   DynArray<functional_detail::result_t<Fn, A const&>>>::type {
+
+        return fmap(std::forward<Fn>(f), static_cast<DynArray<A> const&>(v));
+    }
+};
+
+/*#include <chrono>
+#include <functional>
+
+int main(void) {
     DynArray<int> d(3);
     d.add(1);
     d.add(2);
@@ -238,5 +310,54 @@ private:
     d.add(25);
 
     std::cout << d << std::endl;
+
+    auto twice = [](int x) { return 2 * x; };
+    auto half = [](int x) { return x / 2.0; };
+    std::cout << fmap_(compose(twice, half), d) << " " << (twice % std::move(d)) << std::endl;
+
+    // The same two stage pipeline as a plain loop, through the combinators,
+    // in place on an rvalue, and through std::function as the combinators
+    // were written before
+    const size_t n = 1 << 24, rounds = 10;
+    DynArray<uint32_t> values(n);
+    for (size_t i = 0; i < n; ++i) values.add((uint32_t)(i * 2654435761u >> 8));
+
+    // Unsigned, so that the values may wrap around
+    auto scale = [](uint32_t x) { return 3 * x + 1; };
+    auto mix = [](uint32_t x) { return x ^ (x >> 3); };
+
+    auto time = [&](const char* name, std::function<DynArray<uint32_t>()> run) {
+        long sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) sink += run().data()[r];
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << seconds / rounds * 1e3 << "ms (" << sink << ")" << std::endl;
+    };
+
+    time("plain loop", [&]() {
+        DynArray<uint32_t> out(n);
+        out.resize(n);
+        for (size_t i = 0; i < n; ++i) out.data()[i] = mix(scale(values.data()[i]));
+        return out;
+    });
+
+    time("fmap_(compose(scale, mix), values)", [&]() {
+        return fmap_(compose(scale, mix), values);
+    });
+
+    time("compose(scale, mix) % copy, in place", [&]() {
+        DynArray<uint32_t> copy(values);
+        return compose(scale, mix) % std::move(copy);
+    });
+
+    time("std::function", [&]() {
+        std::function<uint32_t(uint32_t)> f1 = scale, f2 = mix;
+        std::function<uint32_t(uint32_t)> composed = [f1, f2](uint32_t x) { return f2(f1(x)); };
+
+        DynArray<uint32_t> out(n);
+        for (size_t i = 0; i < n; ++i) out.add(composed(values.data()[i]));
+        return out;
+    });
+
     return 0;
 }*/
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include "DynArray.hpp"
+#include "../Headers/Snapshot.hpp"
+
+// Snapshots of DynArrays, kept apart from DynArray.hpp so that the array
+// itself does not depend on file mapping.
+
+// Write the elements of 'values' to a snapshot file
+template <typename T>
+void saveDynArray(DynArray<T> const& values, std::string const& path) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be saved");
+
+    non_std::SnapshotWriter writer(path, non_std::SnapshotKind::DYN_ARRAY, sizeof(T));
+    writer.section(values.data(), sizeof(T) * values.size());
+    writer.close();
+}
+
+// Read the elements of a snapshot file, with a single copy out of the mapping
+template <typename T>
+DynArray<T> loadDynArray(std::string const& path) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be loaded");
+
+    non_std::Snapshot source(path, non_std::SnapshotKind::DYN_ARRAY, sizeof(T), non_std::SnapshotCheck::NOW);
+
+    size_t len = source.count<T>(0);
+    DynArray<T> result(len);
+    result.append(source.section<T>(0, len), len);
+    return result;
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "../13SparseTables/RangeOps.hpp"
+#include "../Headers/CompilerConsts.hpp"
+#include "../Headers/NonSTD.hpp"
+
+// Minimum and maximum of the last 'window' samples of a stream, in O(1)
+// amortized per sample.
+//
+// Each extreme keeps a monotonic deque of the samples which can still become
+// it: a new sample evicts from the back every sample it beats, since those
+// leave the window before it does, and the front is dropped once it falls out
+// of the window. A deque never holds more than 'window' samples, so both live
+// in ring buffers sized once up front and pushing never allocates.
+template <typename T>
+class SlidingWindowMinMax {
+public:
+    explicit SlidingWindowMinMax(size_t length) : window(length) {
+        if (!window) {
+            throw std::invalid_argument("Window must be natural");
+        }
+
+        // Next power of 2, so that wrapping around is a mask
+        capacity = window > 1 ? (size_t)1 << (floor_log2(window - 1) + 1) : 1;
+        mask = capacity - 1;
+
+        minimums = non_std::make_unique<Entry[]>(capacity);
+        maximums = non_std::make_unique<Entry[]>(capacity);
+    }
+
+    SlidingWindowMinMax(SlidingWindowMinMax&&) = default;
+    SlidingWindowMinMax& operator=(SlidingWindowMinMax&&) = default;
+
+    virtual ~SlidingWindowMinMax() = default;
+
+    // Number of samples in the window
+    size_t size() const noexcept {
+        return pushed < window ? (size_t)pushed : window;
+    }
+
+    bool isEmpty() const noexcept {
+        return !pushed;
+    }
+
+    void push(T const& value) noexcept {
+        uint64_t index = pushed++;
+
+        // Drop the fronts which leave the window, first so that the deques
+        // never hold more than 'window' samples
+        if (index >= window) {
+            uint64_t oldest = index - window + 1;
+            if (minBack != minFront && minimums[minFront & mask].index < oldest) ++minFront;
+            if (maxBack != maxFront && maximums[maxFront & mask].index < oldest) ++maxFront;
+        }
+
+        // Evict the samples the new one beats, ties go to the newer sample
+        while (minBack != minFront && !(minimums[(minBack - 1) & mask].value < value)) --minBack;
+        while (maxBack != maxFront && !(value < maximums[(maxBack - 1) & mask].value)) --maxBack;
+
+        minimums[minBack++ & mask] = Entry{value, index};
+        maximums[maxBack++ & mask] = Entry{value, index};
+    }
+
+    // Push the k samples values[0, k)
+    void push(const T* values, size_t k) noexcept {
+        for (size_t i = 0; i < k; ++i) {
+            push(values[i]);
+        }
+    }
+
+    // The window must not be empty
+    T min() const noexcept {
+        return minimums[minFront & mask].value;
+    }
+
+    // The window must not be empty
+    T max() const noexcept {
+        return maximums[maxFront & mask].value;
+    }
+
+    void clear() noexcept {
+        pushed = 0;
+        minFront = minBack = maxFront = maxBack = 0;
+    }
+
+private:
+    struct Entry {
+        T value;
+        uint64_t index;
+    };
+
+    size_t window;
+
+    // Size of both ring buffers, a power of 2 no smaller than the window
+    size_t capacity;
+    size_t mask;
+
+    // Number of samples pushed so far, which is also the index of the next
+    uint64_t pushed = 0;
+
+    // Deques of candidates as [front, back), positions wrap around 'mask'
+    std::unique_ptr<Entry[]> minimums;
+    std::unique_ptr<Entry[]> maximums;
+    size_t minFront = 0, minBack = 0;
+    size_t maxFront = 0, maxBack = 0;
+};
+
+// Aggregate of the last 'window' samples under any associative 'Op' (see
+// RangeOps.hpp) such as SumOp or GcdOp, which need not be invertible nor
+// idempotent, in O(1) amortized per sample and one combine per query.
+//
+// This is the two stack queue cut into chunks of 'window' samples. The
+// current chunk is the back stack, summed up as a running prefix. Once it
+// fills up it becomes the front stack, replaced by the suffix aggregates of
+// its samples in one backward pass. The window then always is a suffix of the
+// previous chunk followed by a prefix of the current one.
+template <typename T, typename Op>
+class SlidingWindowAggregate {
+public:
+    explicit SlidingWindowAggregate(size_t length, Op operation = Op()) :
+        window(length),
+        op(operation)
+    {
+        if (!window) {
+            throw std::invalid_argument("Window must be natural");
+        }
+
+        current = non_std::make_unique<T[]>(window);
+        previous = non_std::make_unique<T[]>(window);
+    }
+
+    SlidingWindowAggregate(SlidingWindowAggregate&&) = default;
+    SlidingWindowAggregate& operator=(SlidingWindowAggregate&&) = default;
+
+    virtual ~SlidingWindowAggregate() = default;
+
+    // Number of samples in the window
+    size_t size() const noexcept {
+        return hasPrevious ? window : filled;
+    }
+
+    bool isEmpty() const noexcept {
+        return !hasPrevious && !filled;
+    }
+
+    void push(T const& value) noexcept {
+        current[filled] = value;
+        prefix = filled ? op(prefix, value) : value;
+
+        if (++filled == window) {
+            T* chunk = current.get();
+            for (size_t i = window - 1; i--; ) {
+                chunk[i] = op(chunk[i], chunk[i + 1]);
+            }
+
+            current.swap(previous);
+            filled = 0;
+            hasPrevious = true;
+        }
+    }
+
+    // Push the k samples values[0, k)
+    void push(const T* values, size_t k) noexcept {
+        for (size_t i = 0; i < k; ++i) {
+            push(values[i]);
+        }
+    }
+
+    // Aggregate of the window, which must not be empty
+    T query() const noexcept {
+        if (!hasPrevious) return prefix;
+        if (!filled) return previous[0];
+
+        return op(previous[filled], prefix);
+    }
+
+    void clear() noexcept {
+        filled = 0;
+        hasPrevious = false;
+    }
+
+private:
+    size_t window;
+
+    Op op;
+
+    // Samples of the current chunk, and the aggregate of the first 'filled'
+    std::unique_ptr<T[]> current;
+    size_t filled = 0;
+    T prefix = T();
+
+    // previous[i] aggregates the samples [i, window) of the previous chunk
+    std::unique_ptr<T[]> previous;
+    bool hasPrevious = false;
+};
+
+/*#include <chrono>
+#include <random>
+#include "../2Arrays/DynArray.hpp"
+#include "Queue.hpp"
+
+template <typename Fn>
+void bench(const char* name, size_t samples, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    long sink = fn();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << samples / seconds / 1e6 << "M samples/s (" << sink << ")" << std::endl;
+}
+
+int main(void) {
+    int stream[8] = {4, 2, 12, 3, 8, 8, 1, 6};
+
+    SlidingWindowMinMax<int> extremes(3);
+    SlidingWindowAggregate<int, GcdOp> gcds(3);
+    for (int value : stream) {
+        extremes.push(value);
+        gcds.push(value);
+        std::cout << extremes.min() << "/" << extremes.max() << "/" << gcds.query() << " ";
+    }
+
+    std::cout << std::endl; // 4/4/4 2/4/2 2/12/2 2/12/1 3/12/1 3/8/1 1/8/1 1/8/1
+
+    const size_t samples = 100000000, window = 1000;
+    std::mt19937 rng(42);
+
+    DynArray<int32_t> data(samples);
+    for (size_t i = 0; i < samples; ++i) data.add((int32_t)(rng() % 1000000));
+    const int32_t* d = data.data();
+
+    bench("SlidingWindowMinMax", samples, [&]() {
+        SlidingWindowMinMax<int32_t> w(window);
+        long sink = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            w.push(d[i]);
+            sink += w.max() - w.min();
+        }
+
+        return sink;
+    });
+
+    bench("SlidingWindowAggregate<SumOp>", samples, [&]() {
+        SlidingWindowAggregate<long, SumOp> w(window);
+        long sink = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            w.push(d[i]);
+            sink += w.query() & 1;
+        }
+
+        return sink;
+    });
+
+    bench("SlidingWindowAggregate<GcdOp>", samples, [&]() {
+        SlidingWindowAggregate<int32_t, GcdOp> w(window);
+        long sink = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            w.push(d[i]);
+            sink += w.query();
+        }
+
+        return sink;
+    });
+
+    // The node based Queue as the window, rescanned for its minimum every
+    // sample, on a hundredth of the stream
+    bench("Queue rescan", samples / 100, [&]() {
+        Queue<int32_t> q;
+        long sink = 0;
+        for (size_t i = 0; i < samples / 100; ++i) {
+            q.offer(d[i]);
+            if (q.sizeOf() > window) q.poll();
+
+            int32_t best = d[i];
+            for (auto it = q.fd_iter(); !it.exhausted(); it.step_forward()) {
+                int32_t value = it.extract().fromJust();
+                best = value < best ? value : best;
+            }
+
+            sink += best;
+        }
+
+        return sink;
+    });
+
+    return 0;
+}*/
@@ -0,0 +1,355 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "../2Arrays/DynArray.hpp"
+
+// Array backed binary heap shared by MinPQ and MaxPQ, where 'Compare'
+// (std::less or std::greater) tells whether an element belongs above another.
+//
+// With 'tracked' enabled every element is mapped to the set of its positions
+// in the heap, which makes contains() O(1), remove() and update() O(log(n))
+// at the cost of linear extra space and hash map updates on every swap.
+//
+// The array is not exposed for writing, since every change to it has to go
+// through the heap to keep both the heap order and the positions right.
+template <typename T, typename Compare, bool tracked = false>
+class BinaryHeap : protected DynArray<T> {
+public:
+    BinaryHeap() : DynArray<T>() {}
+
+    // Heap construction from existing data, takes O(n) time.
+    BinaryHeap(const T* data, size_t len) : DynArray<T>(len) {
+        offerAll(data, len);
+    }
+
+    explicit BinaryHeap(DynArray<T> const& source) : BinaryHeap(source.data(), source.size()) {}
+
+    template <typename It>
+    BinaryHeap(It first, It last) : DynArray<T>() {
+        offerAll(first, last);
+    }
+
+    virtual ~BinaryHeap() = default;
+
+    using DynArray<T>::size;
+    using DynArray<T>::at;
+    using DynArray<T>::reserve;
+
+    // The elements in heap order
+    const T* data() const noexcept {
+        return DynArray<T>::data();
+    }
+
+    static size_t parent(size_t i) noexcept {
+        return (i - 1) / 2;
+    }
+
+    static size_t leftChild(size_t i) noexcept {
+        return 2 * i + 1;
+    }
+
+    static size_t rightChild(size_t i) noexcept {
+        return 2 * i + 2;
+    }
+
+    Maybe<T> poll() noexcept {
+        if (!this->size()) {
+            return Maybe<T>();
+        }
+
+        auto result = this->at(0);
+        size_t last = this->size() - 1;
+
+        swapNodes(0, last);
+        untrack(last, is_tracked());
+        this->removeAt(last);
+
+        if (this->size() > 1) {
+            heapify(0);
+        }
+
+        return result;
+    }
+
+    void offer(T const& val) noexcept {
+        this->add(val);
+        track(this->size() - 1, is_tracked());
+        bubbleUp(this->size() - 1);
+    }
+
+    void offerAll(const T* data, size_t len) noexcept {
+        size_t before = this->size();
+        this->append(data, len);
+        restore(before);
+    }
+
+    template <typename It>
+    void offerAll(It first, It last) noexcept {
+        size_t before = this->size();
+        for (; first != last; ++first) {
+            this->add(*first);
+        }
+
+        restore(before);
+    }
+
+    // Move every element of 'other' into this heap, leaving 'other' empty
+    void merge(BinaryHeap& other) noexcept {
+        if (std::addressof(*this) == std::addressof(other)) return;
+
+        offerAll(other.data(), other.size());
+        other.resize(0);
+        other.clearPositions(is_tracked());
+    }
+
+    // Heap sort: empties the PQ and returns its elements in polling order,
+    // in the array the heap was kept in
+    DynArray<T> drainSorted() noexcept {
+        T* heap = elements();
+
+        for (size_t end = this->size(); end > 1; --end) {
+            std::swap(heap[0], heap[end - 1]);
+            heapify(0, end - 1);
+        }
+
+        // Every step moved the last element to be polled to the back
+        std::reverse(heap, heap + this->size());
+
+        clearPositions(is_tracked());
+        return DynArray<T>(std::move(static_cast<DynArray<T>&>(*this)));
+    }
+
+    bool contains(T const& elem) const noexcept {
+        return contains(elem, is_tracked());
+    }
+
+    // Remove one occurrence of 'elem', returns whether or not it was found
+    bool remove(T const& elem) noexcept {
+        return indexOf(elem, is_tracked()).on(
+            [&](size_t i) {
+                removeNode(i);
+                return true;
+            },
+            []() {
+                return false;
+            }
+        );
+    }
+
+    // Replace one occurrence of 'oldElem' with 'newElem', returns whether or not it was found
+    bool update(T const& oldElem, T const& newElem) noexcept {
+        return indexOf(oldElem, is_tracked()).on(
+            [&](size_t i) {
+                untrack(i, is_tracked());
+                elements()[i] = newElem;
+                track(i, is_tracked());
+                sink(i);
+                return true;
+            },
+            []() {
+                return false;
+            }
+        );
+    }
+
+private:
+    using is_tracked = std::integral_constant<bool, tracked>;
+
+    struct NoPositions {};
+
+    using PositionMap = typename std::conditional<
+        tracked,
+        std::unordered_map<T, std::unordered_set<size_t>>,
+        NoPositions
+    >::type;
+
+    // Whether 'a' belongs above 'b'
+    static bool above(T const& a, T const& b) noexcept {
+        return Compare()(a, b);
+    }
+
+    T* elements() const noexcept {
+        return DynArray<T>::data();
+    }
+
+    // Depth first search which leaves out every subtree whose root 'elem'
+    // belongs above, since nothing below such a root can equal 'elem'.
+    // Returns size() when 'elem' is not in the heap.
+    size_t find(T const& elem) const noexcept {
+        const T* heap = elements();
+        size_t n = this->size();
+
+        // Each pop pushes at most two children, so the stack never holds
+        // more than one node per level plus one
+        size_t stack[2 * 64];
+        size_t top = 0;
+
+        if (n && !above(elem, heap[0])) stack[top++] = 0;
+
+        while (top) {
+            size_t i = stack[--top];
+            if (heap[i] == elem) return i;
+
+            size_t left = leftChild(i);
+            size_t right = rightChild(i);
+            if (right < n && !above(elem, heap[right])) stack[top++] = right;
+            if (left < n && !above(elem, heap[left])) stack[top++] = left;
+        }
+
+        return n;
+    }
+
+    bool contains(T const& elem, std::false_type) const noexcept {
+        return find(elem) < this->size();
+    }
+
+    bool contains(T const& elem, std::true_type) const noexcept {
+        return positions.count(elem) > 0;
+    }
+
+    Maybe<size_t> indexOf(T const& elem, std::false_type) const noexcept {
+        size_t i = find(elem);
+        if (i == this->size()) {
+            return Maybe<size_t>();
+        }
+
+        return return_<Maybe>(i);
+    }
+
+    Maybe<size_t> indexOf(T const& elem, std::true_type) const noexcept {
+        auto it = positions.find(elem);
+        if (it == positions.end()) {
+            return Maybe<size_t>();
+        }
+
+        return return_<Maybe>(*it->second.begin());
+    }
+
+    void track(size_t, std::false_type) noexcept {}
+
+    void track(size_t i, std::true_type) noexcept {
+        positions[elements()[i]].insert(i);
+    }
+
+    void untrack(size_t, std::false_type) noexcept {}
+
+    void untrack(size_t i, std::true_type) noexcept {
+        auto it = positions.find(elements()[i]);
+        it->second.erase(i);
+
+        if (it->second.empty()) {
+            positions.erase(it);
+        }
+    }
+
+    void clearPositions(std::false_type) noexcept {}
+
+    void clearPositions(std::true_type) noexcept {
+        positions.clear();
+    }
+
+    void swapPositions(size_t, size_t, std::false_type) noexcept {}
+
+    void swapPositions(size_t i, size_t j, std::true_type) noexcept {
+        auto& iPositions = positions.find(elements()[i])->second;
+        auto& jPositions = positions.find(elements()[j])->second;
+
+        iPositions.erase(i);
+        jPositions.erase(j);
+        iPositions.insert(j);
+        jPositions.insert(i);
+    }
+
+    void swapNodes(size_t i, size_t j) noexcept {
+        if (i == j) return;
+
+        swapPositions(i, j, is_tracked());
+        std::swap(elements()[i], elements()[j]);
+    }
+
+    // Remove the node at index 'i' by swapping it with the last one
+    void removeNode(size_t i) noexcept {
+        size_t last = this->size() - 1;
+
+        swapNodes(i, last);
+        untrack(last, is_tracked());
+        this->removeAt(last);
+
+        if (i < last) {
+            sink(i);
+        }
+    }
+
+    // Move the node at index 'i' to wherever it belongs
+    void sink(size_t i) noexcept {
+        T const& elem = elements()[i];
+        if (i > 0 && above(elem, elements()[parent(i)])) {
+            bubbleUp(i);
+        }
+        else {
+            heapify(i);
+        }
+    }
+
+    // Restore the heap invariant after elements were appended past 'before'
+    void restore(size_t before) noexcept {
+        size_t n = this->size();
+        size_t added = n - before;
+        if (!added) return;
+
+        for (size_t i = before; i < n; ++i) {
+            track(i, is_tracked());
+        }
+
+        size_t depth = 0;
+        for (size_t s = n; s > 1; s >>= 1) ++depth;
+
+        // k bubble ups cost O(k*log(n)), while Floyd's heapify costs O(n)
+        if (added * depth > n) {
+            for (size_t i = n / 2; i > 0; --i) {
+                heapify(i - 1);
+            }
+        }
+        else {
+            for (size_t i = before; i < n; ++i) {
+                bubbleUp(i);
+            }
+        }
+    }
+
+    // "Bubbling Up"
+    void bubbleUp(size_t i) noexcept {
+        T* heap = elements();
+        for (; i > 0 && above(heap[i], heap[parent(i)]); i = parent(i)) {
+            swapNodes(parent(i), i);
+        }
+    }
+
+    // "Bubbling Down"
+    void heapify(size_t i) noexcept {
+        heapify(i, this->size());
+    }
+
+    void heapify(size_t i, size_t n) noexcept {
+        const T* heap = elements();
+
+        for (;;) {
+            size_t left = leftChild(i);
+            size_t right = rightChild(i);
+            size_t top = i;
+
+            if (left < n && above(heap[left], heap[top])) top = left;
+            if (right < n && above(heap[right], heap[top])) top = right;
+
+            if (top == i) return;
+
+            swapNodes(i, top);
+            i = top;
+        }
+    }
+
+    PositionMap positions;
+};
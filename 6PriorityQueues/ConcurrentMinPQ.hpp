@@ -0,0 +1,211 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "MinPQ.hpp"
+
+// Relaxed min priority queue for many threads (the MultiQueue design):
+// c * P sequential heaps, each guarded by its own lock. Offering goes into
+// a random heap, polling takes the better top of two random heaps.
+//
+// Polling is not linearizable: it may return an element which is not the
+// global minimum. With two random choices the expected rank of a polled
+// element among all queued ones is O(c * P), and O(c * P * log(c * P))
+// with high probability (Alistarh et al., "The Power of Choice in Priority
+// Scheduling", 2017). Nothing is lost: every offered element is polled once.
+template <typename T>
+class ConcurrentMinPQ {
+public:
+    explicit ConcurrentMinPQ(unsigned threads = std::thread::hardware_concurrency(), unsigned c = 2) :
+        numQueues(std::max(2u, std::max(1u, threads) * std::max(1u, c)))
+    {
+        // new[] only honours alignments beyond max_align_t from C++17 on
+        queues = (Queue*)non_std::aligned_malloc(sizeof(Queue) * numQueues, CACHE_LINE);
+        for (size_t i = 0; i < numQueues; ++i) {
+            new (queues + i) Queue();
+        }
+    }
+
+    virtual ~ConcurrentMinPQ() noexcept {
+        for (size_t i = 0; i < numQueues; ++i) {
+            queues[i].~Queue();
+        }
+
+        non_std::aligned_free(queues);
+    }
+
+    ConcurrentMinPQ(ConcurrentMinPQ const&) = delete;
+    ConcurrentMinPQ& operator=(ConcurrentMinPQ const&) = delete;
+
+    Maybe<T> poll() noexcept {
+        if (!count.load(std::memory_order_relaxed)) {
+            return Maybe<T>();
+        }
+
+        // Give up on random choices after this many empty pairs and sweep
+        for (size_t attempt = 0; attempt < numQueues; ++attempt) {
+            size_t i = random() % numQueues;
+            size_t j = random() % (numQueues - 1);
+            if (j >= i) ++j;
+
+            Queue& a = queues[i];
+            Queue& b = queues[j];
+
+            if (!a.lock.try_lock()) continue;
+            if (!b.lock.try_lock()) {
+                a.lock.unlock();
+                continue;
+            }
+
+            Queue* best = nullptr;
+            if (a.pq.size() && (!b.pq.size() || a.pq.data()[0] <= b.pq.data()[0])) best = &a;
+            else if (b.pq.size()) best = &b;
+
+            Maybe<T> result = best ? best->pq.poll() : Maybe<T>();
+
+            b.lock.unlock();
+            a.lock.unlock();
+
+            if (best) {
+                count.fetch_sub(1, std::memory_order_relaxed);
+                return result;
+            }
+        }
+
+        return sweep();
+    }
+
+    void offer(T const& val) noexcept {
+        for (;;) {
+            Queue& q = queues[random() % numQueues];
+
+            if (q.lock.try_lock()) {
+                // Counted before it can be polled, so that the count never drops below zero
+                count.fetch_add(1, std::memory_order_relaxed);
+                q.pq.offer(val);
+                q.lock.unlock();
+                return;
+            }
+        }
+    }
+
+    // Takes O(n) time and locks every heap in turn
+    bool contains(T const& elem) noexcept {
+        for (size_t i = 0; i < numQueues; ++i) {
+            std::lock_guard<std::mutex> guard(queues[i].lock);
+            if (queues[i].pq.contains(elem)) return true;
+        }
+
+        return false;
+    }
+
+    // Exact when no other thread is offering or polling
+    size_t size() const noexcept {
+        return count.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr const size_t CACHE_LINE = 64;
+
+    // Each on its own cache lines, so that neighbouring locks do not share one
+    struct alignas(CACHE_LINE) Queue {
+        std::mutex lock;
+        MinPQ<T> pq;
+    };
+
+    // Poll from the first non-empty heap, waiting for every lock
+    Maybe<T> sweep() noexcept {
+        for (size_t i = 0; i < numQueues; ++i) {
+            std::lock_guard<std::mutex> guard(queues[i].lock);
+
+            if (queues[i].pq.size()) {
+                count.fetch_sub(1, std::memory_order_relaxed);
+                return queues[i].pq.poll();
+            }
+        }
+
+        return Maybe<T>();
+    }
+
+    // Per thread xorshift generator
+    static size_t random() noexcept {
+        thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // The number of sequential heaps, c * P
+    size_t numQueues;
+
+    Queue* queues;
+
+    std::atomic<size_t> count{0};
+};
+
+/*#include <chrono>
+#include <vector>
+
+int main(void) {
+    // Stress test: every offered element is polled exactly once
+    {
+        const unsigned threads = 8;
+        const size_t perThread = 100000;
+
+        ConcurrentMinPQ<size_t> pq(threads);
+        std::vector<std::atomic<unsigned>> seen(threads * perThread);
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (size_t i = 0; i < perThread; ++i) {
+                    pq.offer(t * perThread + i);
+                    if (i % 2) {
+                        // A relaxed poll may miss elements held under other locks
+                        Maybe<size_t> polled;
+                        do polled = pq.poll(); while (polled.isNothing());
+                        seen[polled.fromJust()]++;
+                    }
+                }
+            });
+        }
+
+        for (auto& w : workers) w.join();
+        while (pq.size()) seen[pq.poll().fromJust()]++;
+
+        bool ok = true;
+        for (auto& s : seen) ok = ok && s == 1;
+        std::cout << "stress: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+
+    // Throughput: 50% offer / 50% poll, up to 64 threads
+    for (unsigned threads = 1; threads <= 64; threads *= 2) {
+        const size_t ops = 1 << 22;
+
+        ConcurrentMinPQ<unsigned> pq(threads);
+        for (unsigned i = 0; i < (1 << 20); ++i) pq.offer(i * 2654435761u);
+
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (size_t i = 0; i < ops / threads; ++i) {
+                    if (i % 2) pq.poll();
+                    else pq.offer(unsigned(i * t));
+                }
+            });
+        }
+
+        for (auto& w : workers) w.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << threads << " threads: " << ops / seconds / 1e6 << " Mops/s" << std::endl;
+    }
+
+    return 0;
+}*/
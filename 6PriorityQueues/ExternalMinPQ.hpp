@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "MinPQ.hpp"
+
+// Min priority queue for more elements than fit in memory. Offered elements
+// go into a bounded in-memory MinPQ; once it fills up it is sorted and spilled
+// to disk as a run. Polling merges the in-memory heap with all runs, which are
+// read back in large sequential blocks. To keep the read buffers of the runs
+// within the memory budget, runs are merged a few at a time into longer ones
+// on disk, see pick().
+template <typename T>
+class ExternalMinPQ {
+    static_assert(std::is_trivially_copyable<T>::value, "Elements must be trivially copyable");
+
+public:
+    // Half of 'memoryBudget' bytes is spent on the in-memory heap,
+    // the other half on read buffers of 'blockSize' bytes, one per run.
+    explicit ExternalMinPQ(size_t memoryBudget = 64 << 20, std::string const& tempDir = "/tmp", size_t blockSize = 1 << 20) :
+        dir(tempDir),
+        heapCapacity(std::max<size_t>(1, memoryBudget / 2 / sizeof(T))),
+        blockCapacity(std::max<size_t>(1, std::min(blockSize, memoryBudget / 64) / sizeof(T))),
+        maxRuns(std::max<size_t>(2, memoryBudget / 2 / (blockCapacity * sizeof(T)))),
+        fanIn(std::max<size_t>(2, (size_t)std::sqrt((double)maxRuns)))
+    {
+        // Growing by doubling would overshoot the budget
+        buffer.reserve(heapCapacity);
+    }
+
+    virtual ~ExternalMinPQ() noexcept {
+        for (size_t i = 0; i < runs.size(); ++i) {
+            close(runs.data()[i]);
+        }
+    }
+
+    ExternalMinPQ(ExternalMinPQ const&) = delete;
+    ExternalMinPQ& operator=(ExternalMinPQ const&) = delete;
+
+    Maybe<T> poll() {
+        if (!count) {
+            return Maybe<T>();
+        }
+
+        --count;
+
+        if (!heads.size() || (buffer.size() && !(heads.data()[0].value < buffer.data()[0]))) {
+            return buffer.poll();
+        }
+
+        Head head = heads.poll().fromJust();
+        advance(head.run);
+        return return_<Maybe>(head.value);
+    }
+
+    void offer(T const& val) {
+        if (buffer.size() == heapCapacity) {
+            spill();
+        }
+
+        buffer.offer(val);
+        ++count;
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    // The number of runs currently on disk
+    size_t spilledRuns() const noexcept {
+        return heads.size();
+    }
+
+    // The number of times runs were merged so far
+    size_t mergedRuns() const noexcept {
+        return merges;
+    }
+
+private:
+    // A sorted run on disk with its read buffer
+    struct Run {
+        std::FILE* file = nullptr;
+        std::string path;
+        std::unique_ptr<T[]> block;
+        size_t pos = 0;
+        size_t len = 0;
+
+        // The number of merges its elements went through
+        size_t level = 0;
+
+        // Creation order, older runs have smaller ids
+        size_t id = 0;
+    };
+
+    // The smallest unread element of a run
+    struct Head {
+        T value;
+        size_t run;
+
+        bool operator<(Head const& rhs) const { return value < rhs.value; }
+        bool operator>(Head const& rhs) const { return value > rhs.value; }
+        bool operator==(Head const& rhs) const { return value == rhs.value && run == rhs.run; }
+    };
+
+    // Sort the in-memory heap and write it out as a new run
+    void spill() {
+        Run* run = create(0);
+        {
+            DynArray<T> sorted = buffer.drainSorted();
+
+            try {
+                write(run, sorted.data(), sorted.size());
+            }
+            catch (...) {
+                // Keep the elements, which are still counted; sorted they
+                // already are a heap
+                buffer.offerAll(sorted.data(), sorted.size());
+                throw;
+            }
+        }
+
+        buffer.reserve(heapCapacity);
+        open(run);
+
+        DynArray<size_t> picked;
+        while (pick(picked)) {
+            merge(picked);
+        }
+    }
+
+    // Choose the next 'fanIn' runs to merge, returns false when none are due.
+    //
+    // Runs are merged like the digits of a counter in base 'fanIn': once a
+    // level holds 'fanIn' runs, they become a single run on the next level, so
+    // every element is rewritten once per level, O(log_fanIn(n / heapCapacity))
+    // times in all. With 'fanIn' around the square root of 'maxRuns' there are
+    // more than 'maxRuns' runs only after fanIn^fanIn spills; from then on the
+    // runs of the lowest levels are merged before their level fills up.
+    bool pick(DynArray<size_t>& picked) const {
+        picked.resize(0);
+        for (size_t i = 0; i < runs.size(); ++i) {
+            if (runs.data()[i]) picked.add(i);
+        }
+
+        // Lowest levels first, oldest runs first within a level
+        size_t* first = picked.data();
+        std::sort(first, first + picked.size(), [&](size_t a, size_t b) {
+            Run* ra = runs.data()[a];
+            Run* rb = runs.data()[b];
+            return ra->level != rb->level ? ra->level < rb->level : ra->id < rb->id;
+        });
+
+        size_t start = 0;
+        if (picked.size() <= maxRuns) {
+            // The first 'fanIn' runs which share a level
+            while (start + fanIn <= picked.size() &&
+                   runs.data()[first[start]]->level != runs.data()[first[start + fanIn - 1]]->level) {
+                ++start;
+            }
+
+            if (start + fanIn > picked.size()) return false;
+        }
+
+        for (size_t i = 0; i < fanIn; ++i) {
+            first[i] = first[start + i];
+        }
+
+        picked.resize(fanIn);
+        return true;
+    }
+
+    // Merge the runs at 'picked' into one, streaming through one write buffer.
+    // Runs partly polled already are merged from their current heads on.
+    void merge(DynArray<size_t> const& picked) {
+        MinPQ<Head> sources;
+        size_t level = 0;
+
+        for (size_t i = 0; i < picked.size(); ++i) {
+            size_t index = picked.data()[i];
+            Run* run = runs.data()[index];
+            Head head{run->block[run->pos], index};
+
+            heads.remove(head);
+            sources.offer(head);
+            level = std::max(level, run->level + 1);
+        }
+
+        Run* merged = create(level);
+        std::unique_ptr<T[]> out(new T[blockCapacity]);
+        size_t len = 0;
+
+        while (sources.size()) {
+            Head head = sources.poll().fromJust();
+
+            out[len++] = head.value;
+            if (len == blockCapacity) {
+                write(merged, out.get(), len);
+                len = 0;
+            }
+
+            advance(head.run, sources);
+        }
+
+        write(merged, out.get(), len);
+        ++merges;
+        open(merged);
+    }
+
+    Run* create(size_t level) {
+        Run* run = new Run();
+        run->level = level;
+        run->id = nextId++;
+        run->path = dir + "/extpq-" + std::to_string((uintptr_t)this) + "-" + std::to_string(run->id) + ".run";
+        run->file = std::fopen(run->path.c_str(), "w+b");
+
+        if (!run->file) {
+            delete run;
+            throw std::runtime_error("Unable to create run file in " + dir);
+        }
+
+        return run;
+    }
+
+    static void write(Run* run, const T* data, size_t len) {
+        if (std::fwrite(data, sizeof(T), len, run->file) != len) {
+            close(run);
+            throw std::runtime_error("Unable to write run file");
+        }
+    }
+
+    // Start reading a freshly written run from its beginning
+    void open(Run* run) {
+        std::rewind(run->file);
+        run->block.reset(new T[blockCapacity]);
+
+        // Take the slot of an exhausted run, no head refers to it anymore
+        size_t index = 0;
+        while (index < runs.size() && runs.data()[index]) ++index;
+
+        if (index == runs.size()) runs.add(run);
+        else runs.data()[index] = run;
+
+        if (refill(run)) {
+            heads.offer(Head{run->block[0], index});
+        }
+        else {
+            close(runs.data()[index]);
+        }
+    }
+
+    bool refill(Run* run) noexcept {
+        run->pos = 0;
+        run->len = std::fread(run->block.get(), sizeof(T), blockCapacity, run->file);
+        return run->len > 0;
+    }
+
+    void advance(size_t index) {
+        advance(index, heads);
+    }
+
+    // Push the next element of a run as its new head into 'into', deleting the run once it is exhausted
+    void advance(size_t index, MinPQ<Head>& into) {
+        Run*& run = runs.data()[index];
+
+        if (++run->pos < run->len || refill(run)) {
+            into.offer(Head{run->block[run->pos], index});
+        }
+        else {
+            close(run);
+        }
+    }
+
+    static void close(Run*& run) noexcept {
+        if (!run) return;
+
+        std::fclose(run->file);
+        std::remove(run->path.c_str());
+        delete run;
+        run = nullptr;
+    }
+
+    // Directory for run files
+    std::string dir;
+
+    // Maximum number of elements kept in the in-memory heap
+    size_t heapCapacity;
+
+    // Number of elements read from a run at once
+    size_t blockCapacity;
+
+    // The most runs read from at once, one read buffer each
+    size_t maxRuns;
+
+    // The number of runs merged into one at a time
+    size_t fanIn;
+
+    // The number of elements in the queue, both in memory and on disk
+    size_t count = 0;
+
+    size_t nextId = 0;
+
+    size_t merges = 0;
+
+    MinPQ<T> buffer;
+
+    MinPQ<Head> heads;
+
+    // Runs indexed by Head::run, exhausted ones are null
+    DynArray<Run*> runs;
+};
+
+/*#include <chrono>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+// Usage: bench <memory budget in MiB> [temp dir]
+// The dataset is 10x the memory budget: pass the machine's RAM size
+// for the full benchmark, or a few MiB for a quick test run.
+int main(int argc, char** argv) {
+    size_t budget = (argc > 1 ? std::stoull(argv[1]) : 4) << 20;
+    std::string dir = argc > 2 ? argv[2] : "/tmp";
+    size_t n = 10 * budget / sizeof(uint64_t);
+
+    std::mt19937_64 rng(42);
+
+    // Many merges: a 64 KiB budget with 1 KiB blocks spills every 4096
+    // elements and reads at most 32 runs, merged 5 at a time. Polls between
+    // the offers leave partly read runs to be merged.
+    {
+        ExternalMinPQ<uint64_t> small(64 << 10, dir, 1 << 10);
+        std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> reference;
+        bool matches = true;
+
+        for (size_t i = 0; i < 1000000; ++i) {
+            uint64_t val = rng() % 1000000;
+            small.offer(val);
+            reference.push(val);
+
+            if (i % 3 == 0) {
+                matches = matches && small.poll().fromJust() == reference.top();
+                reference.pop();
+            }
+        }
+
+        std::cout << "runs on disk: " << small.spilledRuns() << ", merges: " << small.mergedRuns() << std::endl;
+
+        while (small.size()) {
+            matches = matches && small.poll().fromJust() == reference.top();
+            reference.pop();
+        }
+
+        std::cout << "merged runs drain in order: " << (matches && reference.empty() ? "yes" : "NO") << std::endl;
+    }
+
+    ExternalMinPQ<uint64_t> pq(budget, dir);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        pq.offer(rng());
+    }
+
+    auto filled = std::chrono::steady_clock::now();
+    std::cout << "runs on disk: " << pq.spilledRuns() << std::endl;
+
+    uint64_t prev = 0;
+    bool sorted = true;
+
+    while (pq.size()) {
+        uint64_t val = pq.poll().fromJust();
+        sorted = sorted && prev <= val;
+        prev = val;
+    }
+
+    auto drained = std::chrono::steady_clock::now();
+
+    std::cout << n << " elements, sorted: " << (sorted ? "yes" : "NO") << std::endl;
+    std::cout << "offer: " << std::chrono::duration<double>(filled - start).count() << "s" << std::endl;
+    std::cout << "poll: " << std::chrono::duration<double>(drained - filled).count() << "s" << std::endl;
+    return 0;
+}*/
@@ -1,112 +1,17 @@
 #pragma once
 
-#include "../2Arrays/DynArray.hpp"
+#include "BinaryHeap.hpp"
 
-template <typename T>
-class MinPQ : public DynArray<T> {
+template <typename T, bool tracked = false>
+class MinPQ : public BinaryHeap<T, std::less<T>, tracked> {
 public:
-    MinPQ() : DynArray<T>() {}
+    using BinaryHeap<T, std::less<T>, tracked>::BinaryHeap;
 
     virtual ~MinPQ() = default;
-
-    static size_t parent(size_t i) noexcept {
-        return (i - 1) / 2;
-    }
-
-    static size_t leftChild(size_t i) noexcept {
-        return 2 * i + 1;
-    }
-
-    static size_t rightChild(size_t i) noexcept {
-        return 2 * i + 2;
-    }
-
-    Maybe<T> poll() noexcept {
-        if (!this->size()) {
-            return Maybe<T>();
-        }
-
-        auto result = this->at(0);
-
-        if (this->size() == 1) {
-            this->removeAt(0);
-            return result;
-        }
-
-        std::swap(this->operator[](0), this->operator[](this->size() - 1));
-        this->removeAt(this->size() - 1);
-
-        if (this->size() == 1) {
-            return result;
-        }
-
-        heapify(0);
-        return result;
-    }
-
-    void offer(T const& val) noexcept {
-        this->add(val);
-
-        // "Bubbling Up"
-        for (size_t i = this->size() - 1; i > 0 && this->at(parent(i)).fromJust() > this->at(i).fromJust(); i = parent(i)) {
-            std::swap(this->operator[](parent(i)), this->operator[](i));
-        }
-    }
-
-    bool contains(T const& elem) const noexcept {
-        if (!this->size() || this->at(0).fromJust() > elem) {
-            return false;
-        }
-
-        return fix(
-            [&](auto f, size_t i) -> bool {
-                return (this->at(i).fromJust() == elem) || (
-                        (i < this->size()) && (
-                            (
-                                this->at(leftChild(i)).on(
-                                   [&](T const& val) {
-                                       return val <= elem;
-                                   },
-                                   []() {
-                                       return false;
-                                   }
-                                ) ? f(leftChild(i)) : false
-                            ) ||
-                            (
-                                this->at(rightChild(i)).on(
-                                   [&](T const& val) {
-                                       return val <= elem;
-                                   },
-                                   []() {
-                                       return false;
-                                   }
-                                ) ? f(rightChild(i)) : false
-                            )
-                        )
-                );
-            }
-        )(0);
-    }
-
-private:
-    // "Bubbling Down"
-    void heapify(size_t i) noexcept {
-        size_t left = leftChild(i);
-        size_t right = rightChild(i);
-        size_t smallest = i;
-
-        if (left < this->size() && this->operator[](left) < this->operator[](smallest)) smallest = left;
-        if (right < this->size() && this->operator[](right) < this->operator[](smallest)) smallest = right;
-
-        if (smallest != i) {
-            std::swap(this->operator[](i), this->operator[](smallest));
-            heapify(smallest);
-        }
-    }
 };
 
 /*int main(void) {
-    MinPQ<int> pq;
+    MinPQ<int, true> pq;
 
     pq.offer(1);
     pq.offer(10);
@@ -121,8 +26,13 @@ private:
     std::cout << (pq.contains(15) ? "+" : "-") << std::endl;
     std::cout << (pq.contains(12) ? "+" : "-") << std::endl;
 
-    size_t sz = pq.size();
-    for (size_t i = 0; i < sz; ++i) {
-        std::cout << pq.poll().fromJust() << std::endl;
-    }
+    pq.remove(9);
+    pq.update(10, 12);
+    std::cout << (pq.contains(12) ? "+" : "-") << std::endl;
+
+    int values[] = {7, 3, 8, 2};
+    MinPQ<int, true> other(values, 4);
+    pq.merge(other);
+
+    std::cout << pq.drainSorted() << std::endl;
 }*/
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <utility>
+#include "../2Arrays/DynArray.hpp"
+
+// Min priority queue as a heap-ordered multiway tree. Offering and melding
+// take O(1) time, polling takes amortized O(log(n)) time with two-pass pairing.
+template <typename T>
+class PairingHeap {
+public:
+    PairingHeap() = default;
+
+    virtual ~PairingHeap() noexcept {
+        clear();
+    }
+
+    PairingHeap(PairingHeap const&) = delete;
+    PairingHeap& operator=(PairingHeap const&) = delete;
+
+    PairingHeap(PairingHeap&& source) noexcept {
+        std::swap(root, source.root);
+        std::swap(count, source.count);
+    }
+
+    PairingHeap& operator=(PairingHeap&& source) noexcept {
+        clear();
+        std::swap(root, source.root);
+        std::swap(count, source.count);
+        return *this;
+    }
+
+    Maybe<T> poll() noexcept {
+        if (!root) {
+            return Maybe<T>();
+        }
+
+        auto result = return_<Maybe>(root->value);
+        Node* children = root->child;
+
+        delete root;
+        root = mergePairs(children);
+        --count;
+        return result;
+    }
+
+    void offer(T const& val) noexcept {
+        root = link(root, new Node(val));
+        ++count;
+    }
+
+    // Move every element of 'other' into this heap in O(1), leaving 'other' empty
+    void merge(PairingHeap& other) noexcept {
+        if (std::addressof(*this) == std::addressof(other)) return;
+
+        root = link(root, other.root);
+        count += other.count;
+
+        other.root = nullptr;
+        other.count = 0;
+    }
+
+    // Search the subtrees whose roots do not exceed 'elem', takes O(n) time
+    bool contains(T const& elem) const noexcept {
+        bool found = false;
+
+        walk([&](Node* node) {
+            if (node->value == elem) {
+                found = true;
+                return Step::STOP;
+            }
+
+            // Nothing below a greater value can match
+            return elem < node->value ? Step::SKIP : Step::DESCEND;
+        });
+
+        return found;
+    }
+
+    void clear() noexcept {
+        DynArray<Node*> nodes;
+
+        walk([&](Node* node) {
+            nodes.add(node);
+            return Step::DESCEND;
+        });
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            delete nodes.data()[i];
+        }
+
+        root = nullptr;
+        count = 0;
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+private:
+    struct Node {
+        explicit Node(T const& val) noexcept : value(val) {}
+
+        T value;
+
+        // Leftmost child and the next sibling to the right
+        Node* child = nullptr;
+        Node* sibling = nullptr;
+    };
+
+    // What a walk does after visiting a node
+    enum class Step {
+        SKIP,    // Leave out the children of the node
+        DESCEND, // Visit the children of the node too
+        STOP     // End the walk
+    };
+
+    // Preorder traversal without recursion, 'visit' decides how to go on
+    template <typename Visit>
+    void walk(Visit&& visit) const {
+        if (!root) return;
+
+        DynArray<Node*> stack;
+        stack.add(root);
+
+        while (stack.size()) {
+            Node* node = stack.data()[stack.size() - 1];
+            stack.resize(stack.size() - 1);
+
+            Step step = visit(node);
+            if (step == Step::STOP) return;
+
+            if (node->sibling) stack.add(node->sibling);
+            if (step == Step::DESCEND && node->child) stack.add(node->child);
+        }
+    }
+
+    // Make the greater of two roots the leftmost child of the other one
+    static Node* link(Node* a, Node* b) noexcept {
+        if (!a) return b;
+        if (!b) return a;
+
+        if (b->value < a->value) std::swap(a, b);
+
+        b->sibling = a->child;
+        a->child = b;
+        return a;
+    }
+
+    // Two-pass pairing: link siblings pairwise from left to right,
+    // then link the results into one tree from right to left.
+    static Node* mergePairs(Node* first) noexcept {
+        Node* paired = nullptr;
+
+        while (first) {
+            Node* a = first;
+            Node* b = a->sibling;
+
+            if (!b) {
+                a->sibling = paired;
+                paired = a;
+                break;
+            }
+
+            first = b->sibling;
+            a->sibling = b->sibling = nullptr;
+
+            Node* tree = link(a, b);
+            tree->sibling = paired;
+            paired = tree;
+        }
+
+        Node* result = nullptr;
+
+        while (paired) {
+            Node* next = paired->sibling;
+            paired->sibling = nullptr;
+            result = link(result, paired);
+            paired = next;
+        }
+
+        return result;
+    }
+
+    // The number of elements in the heap
+    size_t count = 0;
+
+    Node* root = nullptr;
+};
+
+/*#include <chrono>
+#include <random>
+#include "MinPQ.hpp"
+#include "RadixHeap.hpp"
+
+template <typename Workload>
+double measure(Workload&& workload) {
+    auto start = std::chrono::steady_clock::now();
+    workload();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename PQ>
+void monotone(PQ& pq, size_t n) {
+    std::mt19937 rng(42);
+    unsigned now = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        pq.offer(now + rng() % 1024);
+        if (i % 2) now = pq.poll().fromJust();
+    }
+
+    while (pq.size()) pq.poll();
+}
+
+template <typename PQ>
+void randomKeys(PQ& pq, size_t n) {
+    std::mt19937 rng(42);
+
+    for (size_t i = 0; i < n; ++i) pq.offer(rng());
+    while (pq.size()) pq.poll();
+}
+
+void report(const char* shape, const char* const names[], const double times[], size_t count) {
+    size_t best = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::cout << shape << " / " << names[i] << ": " << times[i] << "s" << std::endl;
+        if (times[i] < times[best]) best = i;
+    }
+
+    std::cout << shape << " winner: " << names[best] << std::endl;
+}
+
+int main(void) {
+    const size_t n = 1 << 22;
+
+    {
+        const char* const names[] = {"MinPQ", "RadixHeap", "PairingHeap"};
+        MinPQ<unsigned> a; RadixHeap<unsigned> b; PairingHeap<unsigned> c;
+        double times[] = {
+            measure([&]() { monotone(a, n); }),
+            measure([&]() { monotone(b, n); }),
+            measure([&]() { monotone(c, n); })
+        };
+
+        report("monotone", names, times, 3);
+    }
+
+    {
+        const char* const names[] = {"MinPQ", "PairingHeap"};
+        MinPQ<unsigned> a; PairingHeap<unsigned> b;
+        double times[] = {
+            measure([&]() { randomKeys(a, n); }),
+            measure([&]() { randomKeys(b, n); })
+        };
+
+        report("random", names, times, 2);
+    }
+
+    {
+        const char* const names[] = {"MinPQ", "PairingHeap"};
+        double times[] = {
+            measure([&]() {
+                MinPQ<unsigned> acc;
+                for (unsigned i = 0; i < n / 64; ++i) {
+                    MinPQ<unsigned> part;
+                    for (unsigned j = 0; j < 64; ++j) part.offer(i * j);
+                    acc.merge(part);
+                }
+            }),
+            measure([&]() {
+                PairingHeap<unsigned> acc;
+                for (unsigned i = 0; i < n / 64; ++i) {
+                    PairingHeap<unsigned> part;
+                    for (unsigned j = 0; j < 64; ++j) part.offer(i * j);
+                    acc.merge(part);
+                }
+            })
+        };
+
+        report("meld", names, times, 2);
+    }
+
+    return 0;
+}*/
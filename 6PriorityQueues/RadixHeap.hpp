@@ -0,0 +1,119 @@
+#pragma once
+
+#include <limits>
+#include <type_traits>
+#include "../2Arrays/DynArray.hpp"
+#include "../Headers/CompilerConsts.hpp"
+
+// Monotone min priority queue over unsigned integer keys: a key offered must
+// not be less than the last polled one (as in Dijkstra with non-negative weights
+// or timer queues). Offering and polling take amortized O(log(C)) time, where C
+// is the key range, and never compare keys which sit in different buckets.
+// A payload can be carried in the low bits of a wider key, e.g. (dist << 32) | node.
+template <typename T>
+class RadixHeap {
+    static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value, "Keys must be unsigned integers");
+
+    static constexpr const unsigned B = std::numeric_limits<T>::digits + 1;
+
+public:
+    RadixHeap() = default;
+
+    virtual ~RadixHeap() = default;
+
+    Maybe<T> poll() noexcept {
+        if (!count) {
+            return Maybe<T>();
+        }
+
+        if (!buckets[0].size()) {
+            redistribute();
+        }
+
+        buckets[0].removeAt(buckets[0].size() - 1);
+        --count;
+        return return_<Maybe>(last);
+    }
+
+    void offer(T const& val) {
+        if (val < last) {
+            throw std::invalid_argument("Key is less than the last polled one");
+        }
+
+        buckets[bucket(val)].add(val);
+        ++count;
+    }
+
+    // Every key lives in the bucket of its highest bit differing from 'last',
+    // so only that bucket has to be searched.
+    bool contains(T const& elem) const noexcept {
+        if (!count || elem < last) {
+            return false;
+        }
+
+        DynArray<T> const& b = buckets[bucket(elem)];
+        const T* keys = b.data();
+
+        for (size_t i = 0; i < b.size(); ++i) {
+            if (keys[i] == elem) return true;
+        }
+
+        return false;
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+private:
+    unsigned bucket(T val) const noexcept {
+        return val == last ? 0 : floor_log2(val ^ last) + 1;
+    }
+
+    // Move the first non-empty bucket down once its minimum becomes 'last'.
+    // Each key can only move to a lower bucket, which bounds the amortized cost.
+    void redistribute() noexcept {
+        unsigned i = 1;
+        while (!buckets[i].size()) ++i;
+
+        DynArray<T>& b = buckets[i];
+        const T* keys = b.data();
+
+        last = keys[0];
+        for (size_t j = 1; j < b.size(); ++j) {
+            if (keys[j] < last) last = keys[j];
+        }
+
+        for (size_t j = 0; j < b.size(); ++j) {
+            buckets[bucket(keys[j])].add(keys[j]);
+        }
+
+        b.resize(0);
+    }
+
+    // The number of keys in the heap
+    size_t count = 0;
+
+    // The last polled key
+    T last = 0;
+
+    // buckets[i] holds the keys whose highest bit differing from 'last' is i - 1
+    DynArray<T> buckets[B];
+};
+
+/*int main(void) {
+    RadixHeap<unsigned> rh;
+
+    rh.offer(5);
+    rh.offer(1);
+    rh.offer(9);
+
+    std::cout << rh.poll() << std::endl;
+    rh.offer(3);
+
+    std::cout << (rh.contains(9) ? "+" : "-") << std::endl;
+
+    while (rh.size()) {
+        std::cout << rh.poll() << std::endl;
+    }
+}*/
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "Edge.hpp"
+#include "../Headers/NonSTD.hpp"
+
+enum class PathCompression {
+    FULL,      // Two passes, every node on the path points to the root
+    HALVING,   // One pass, every other node on the path points to its grandparent
+    SPLITTING  // One pass, every node on the path points to its grandparent
+};
+
+// Union find with union by rank over indices of type 'Index' (uint32_t or
+// uint64_t). Every element takes two indices in a single array: the parent,
+// or the rank for roots, and the component size, which is kept for roots only.
+// With uint32_t indices this is 8 bytes per element, half of UnionFind's 16,
+// for up to 2^31 - 1 elements.
+template <typename Index = uint32_t, PathCompression compression = PathCompression::HALVING>
+class CompactUnionFind {
+    static_assert(std::is_integral<Index>::value && std::is_unsigned<Index>::value, "Index must be an unsigned integer");
+
+    // Set in the parent field of roots, whose remaining bits hold the rank
+    static constexpr const Index ROOT = Index(1) << (std::numeric_limits<Index>::digits - 1);
+
+public:
+    explicit CompactUnionFind(size_t n) :
+        numComponents(n),
+        count(n)
+    {
+        if (n >= ROOT) {
+            throw std::invalid_argument("Too many elements for the index type");
+        }
+
+        entries = (Entry*)non_std::aligned_malloc(sizeof(Entry) * (n ? n : 1), CACHE_LINE);
+        for (size_t i = 0; i < n; ++i) {
+            entries[i].parent = ROOT; // self-root of rank 0
+            entries[i].sz = 1;
+        }
+    }
+
+    virtual ~CompactUnionFind() noexcept {
+        non_std::aligned_free(entries);
+    }
+
+    CompactUnionFind(CompactUnionFind const&) = delete;
+    CompactUnionFind& operator=(CompactUnionFind const&) = delete;
+
+    CompactUnionFind(CompactUnionFind&& source) noexcept {
+        std::swap(entries, source.entries);
+        std::swap(count, source.count);
+        std::swap(numComponents, source.numComponents);
+    }
+
+    CompactUnionFind& operator=(CompactUnionFind&& source) noexcept {
+        std::swap(entries, source.entries);
+        std::swap(count, source.count);
+        std::swap(numComponents, source.numComponents);
+        return *this;
+    }
+
+    // Find which component/set 'p' belongs to, takes amortized constant time.
+    size_t find(size_t p) noexcept {
+        return find(Index(p), std::integral_constant<PathCompression, compression>());
+    }
+
+    // Return whether or not the elements 'p' and
+    // 'q' are in the same components/set.
+    bool connected(size_t p, size_t q) noexcept {
+        return find(p) == find(q);
+    }
+
+    // Return the size of the component/set 'p' belongs to
+    size_t componentSize(size_t p) noexcept {
+        return entries[find(p)].sz;
+    }
+
+    // Returns the number of remaining components/sets
+    size_t components() const noexcept {
+        return numComponents;
+    }
+
+    // Returns the number of elements
+    size_t size() const noexcept {
+        return count;
+    }
+
+    // Unify the components/sets containing elements 'p' and 'q'
+    void unify(size_t p, size_t q) noexcept {
+        Index root1 = Index(find(p));
+        Index root2 = Index(find(q));
+
+        // These elements are already in the same group
+        if (root1 == root2) return;
+
+        Index rank1 = entries[root1].parent & ~ROOT;
+        Index rank2 = entries[root2].parent & ~ROOT;
+
+        // Hang the root of lower rank under the other one
+        if (rank1 < rank2) std::swap(root1, root2);
+        if (rank1 == rank2) ++entries[root1].parent;
+
+        entries[root1].sz += entries[root2].sz;
+        entries[root2].parent = root1;
+
+        --numComponents;
+    }
+
+    // Unify the endpoints of 'm' edges, grouped by root for locality
+    void unifyBatch(const Edge* edges, size_t m) {
+        unifyByRoots(*this, edges, m);
+    }
+
+private:
+    static constexpr const size_t CACHE_LINE = 64;
+
+    struct Entry {
+        // Parent index, or ROOT | rank if this is a root node
+        Index parent;
+
+        // Size of the component, only meaningful for root nodes
+        Index sz;
+    };
+
+    bool isRoot(Index p) const noexcept {
+        return entries[p].parent & ROOT;
+    }
+
+    Index find(Index p, std::integral_constant<PathCompression, PathCompression::FULL>) noexcept {
+        Index root = p;
+        while (!isRoot(root)) root = entries[root].parent;
+
+        while (!isRoot(p) && entries[p].parent != root) {
+            Index next = entries[p].parent;
+            entries[p].parent = root;
+            p = next;
+        }
+
+        return root;
+    }
+
+    Index find(Index p, std::integral_constant<PathCompression, PathCompression::HALVING>) noexcept {
+        while (!isRoot(p)) {
+            Index next = entries[p].parent;
+            if (isRoot(next)) return next;
+
+            entries[p].parent = entries[next].parent;
+            p = entries[p].parent;
+        }
+
+        return p;
+    }
+
+    Index find(Index p, std::integral_constant<PathCompression, PathCompression::SPLITTING>) noexcept {
+        while (!isRoot(p)) {
+            Index next = entries[p].parent;
+            if (isRoot(next)) return next;
+
+            entries[p].parent = entries[next].parent;
+            p = next;
+        }
+
+        return p;
+    }
+
+    // The number of components in the union find
+    size_t numComponents = 0;
+
+    // The number of elements
+    size_t count = 0;
+
+    Entry* entries = nullptr;
+};
+
+/*#include <chrono>
+#include <random>
+#include "DynamicUnionFind.hpp"
+
+template <typename UF>
+void workload(const char* name, size_t n, size_t unions, size_t finds) {
+    UF uf(n);
+    std::mt19937_64 rng(42);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < unions; ++i) uf.unify(rng() % n, rng() % n);
+
+    size_t sink = 0;
+    for (size_t i = 0; i < finds; ++i) sink += uf.find(rng() % n);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << seconds << "s (" << sink % 2 << ")" << std::endl;
+}
+
+template <typename UF>
+void compare(const char* name, size_t n) {
+    std::cout << name << std::endl;
+    workload<UF>("  find-heavy", n, n / 4, 4 * n);
+    workload<UF>("  unify-heavy", n, 2 * n, n / 4);
+}
+
+int main(void) {
+    const size_t n = 1 << 24;
+
+    compare<DynamicUnionFind>("DynamicUnionFind", n);
+    compare<CompactUnionFind<uint32_t, PathCompression::FULL>>("Compact<uint32_t, FULL>", n);
+    compare<CompactUnionFind<uint32_t, PathCompression::HALVING>>("Compact<uint32_t, HALVING>", n);
+    compare<CompactUnionFind<uint32_t, PathCompression::SPLITTING>>("Compact<uint32_t, SPLITTING>", n);
+    compare<CompactUnionFind<uint64_t, PathCompression::HALVING>>("Compact<uint64_t, HALVING>", n);
+    return 0;
+}*/
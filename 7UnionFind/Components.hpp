@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "../2Arrays/DynArray.hpp"
+
+// Call fn(member) for every member of the component/set 'p' belongs to, by
+// following the circular list of members through uf.nextMember(). Takes time
+// proportional to the size of the component.
+template <typename UF, typename Fn>
+void forEachComponentMember(UF const& uf, size_t p, Fn&& fn) {
+    size_t member = p;
+    do {
+        fn(member);
+        member = uf.nextMember(member);
+    } while (member != p);
+}
+
+// Label each of the uf.size() elements with the index of its component/set,
+// numbered 0..uf.components() - 1 in the order of their smallest elements
+template <typename UF>
+DynArray<uint32_t> labelComponents(UF& uf) {
+    size_t n = uf.size();
+
+    DynArray<uint32_t> labels(n);
+    labels.resize(n);
+
+    uint32_t* out = labels.data();
+    std::fill(out, out + n, UINT32_MAX);
+
+    // A root is either behind 'i' and labelled already, or gets its label now
+    uint32_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t root = uf.find(i);
+        if (out[root] == UINT32_MAX) out[root] = k++;
+        out[i] = out[root];
+    }
+
+    return labels;
+}
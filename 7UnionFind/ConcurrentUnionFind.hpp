@@ -0,0 +1,187 @@
+#pragma once
+
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include "Edge.hpp"
+#include "../Headers/NonSTD.hpp"
+#include "../Headers/Parallel.hpp"
+
+// Union find which can be shared between threads without locks.
+//
+// 'find' walks up with path halving, where each shortcut is a single CAS:
+// losing the race only means the shortcut is not taken, so the walk never
+// waits on other threads. 'unify' links one root under the other with a CAS
+// which fails if the root got linked elsewhere meanwhile, then retries.
+// Roots are linked in the order of a fixed pseudo-random priority of their
+// indices (randomized linking, as in Jayanti & Tarjan), which keeps the trees
+// shallow and can never form a cycle.
+//
+// Component sizes are not tracked, as that would need a second atomic per root.
+class ConcurrentUnionFind {
+public:
+    explicit ConcurrentUnionFind(size_t n) :
+        numComponents(n),
+        count(n),
+        id(non_std::make_unique<std::atomic<size_t>[]>(n ? n : 1))
+    {
+        for (size_t i = 0; i < n; ++i) {
+            id[i].store(i, std::memory_order_relaxed); // self-root
+        }
+    }
+
+    virtual ~ConcurrentUnionFind() = default;
+
+    ConcurrentUnionFind(ConcurrentUnionFind&& source) noexcept :
+        numComponents(source.numComponents.load()),
+        count(source.count),
+        id(std::move(source.id))
+    {}
+
+    // Find which component/set 'p' belongs to
+    size_t find(size_t p) noexcept {
+        for (;;) {
+            size_t parent = id[p].load(std::memory_order_acquire);
+            if (parent == p) return p;
+
+            size_t grandparent = id[parent].load(std::memory_order_acquire);
+            if (grandparent != parent) {
+                // Benign: if another thread changed id[p] first, skip the shortcut
+                id[p].compare_exchange_weak(parent, grandparent, std::memory_order_release, std::memory_order_relaxed);
+            }
+
+            p = grandparent;
+        }
+    }
+
+    // Return whether or not the elements 'p' and
+    // 'q' are in the same components/set.
+    bool connected(size_t p, size_t q) noexcept {
+        for (;;) {
+            p = find(p);
+            q = find(q);
+
+            if (p == q) return true;
+
+            // 'p' might have been linked under 'q' after it was found
+            if (id[p].load(std::memory_order_acquire) == p) return false;
+        }
+    }
+
+    // Returns the number of remaining components/sets
+    size_t components() const noexcept {
+        return numComponents.load(std::memory_order_relaxed);
+    }
+
+    // Returns the number of elements
+    size_t size() const noexcept {
+        return count;
+    }
+
+    // Unify the components/sets containing elements 'p' and 'q',
+    // returns whether or not they were separate before.
+    bool unify(size_t p, size_t q) noexcept {
+        for (;;) {
+            size_t root1 = find(p);
+            size_t root2 = find(q);
+
+            // These elements are already in the same group
+            if (root1 == root2) return false;
+
+            // Hang the root of lower priority under the other one
+            if (lowerPriority(root2, root1)) std::swap(root1, root2);
+
+            size_t expected = root1;
+            if (id[root1].compare_exchange_strong(expected, root2, std::memory_order_acq_rel)) {
+                numComponents.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            p = root1;
+            q = root2;
+        }
+    }
+
+private:
+    // splitmix64 finalizer as a fixed random permutation of indices
+    static uint64_t priority(uint64_t x) noexcept {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    static bool lowerPriority(size_t a, size_t b) noexcept {
+        uint64_t pa = priority(a);
+        uint64_t pb = priority(b);
+        return pa < pb || (pa == pb && a < b);
+    }
+
+    // The number of components in the union find
+    std::atomic<size_t> numComponents;
+
+    // The number of elements
+    size_t count;
+
+    // id[i] points to the parent of i, if id[i] = i then i is a root node
+    std::unique_ptr<std::atomic<size_t>[]> id;
+};
+
+// Unify the 'm' edges over 'n' elements with 'threads' threads
+inline ConcurrentUnionFind parallelConnectedComponents(size_t n, const Edge* edges, size_t m, unsigned threads = non_std::hardware_threads()) {
+    ConcurrentUnionFind uf(n);
+
+    non_std::parallel_for(0, m, threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uf.unify(edges[i].from, edges[i].to);
+        }
+    });
+
+    return uf;
+}
+
+/*#include <chrono>
+#include <random>
+#include <vector>
+#include "UnionFind.hpp"
+
+int main(void) {
+    // Correctness against the sequential UnionFind
+    {
+        const size_t n = 10000;
+        std::mt19937_64 rng(42);
+        std::vector<Edge> edges(n);
+        for (auto& e : edges) e = Edge{rng() % n, rng() % n};
+
+        auto sequential = non_std::make_unique<UnionFind<n>>();
+        for (auto& e : edges) sequential->unify(e.from, e.to);
+
+        ConcurrentUnionFind concurrent = parallelConnectedComponents(n, edges.data(), edges.size(), 8);
+
+        bool ok = sequential->components() == concurrent.components();
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = rng() % n;
+            ok = ok && sequential->connected(i, j) == concurrent.connected(i, j);
+        }
+
+        std::cout << "correctness: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+
+    // Scaling up to all available cores
+    {
+        const size_t n = 1 << 24;
+        std::mt19937_64 rng(42);
+        std::vector<Edge> edges(4 * n);
+        for (auto& e : edges) e = Edge{rng() % n, rng() % n};
+
+        for (unsigned threads = 1; threads <= non_std::hardware_threads(); threads *= 2) {
+            auto start = std::chrono::steady_clock::now();
+            ConcurrentUnionFind uf = parallelConnectedComponents(n, edges.data(), edges.size(), threads);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << threads << " threads: " << seconds << "s, " << uf.components() << " components" << std::endl;
+        }
+    }
+
+    return 0;
+}*/
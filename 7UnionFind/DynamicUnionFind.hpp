@@ -0,0 +1,245 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "Components.hpp"
+#include "Edge.hpp"
+#include "../Headers/NonSTD.hpp"
+
+namespace non_std {
+    class Snapshot;
+}
+
+struct UnionFindSnapshot;
+
+// Union find sized at runtime, which can grow one element at a time.
+// Parent and size of every element are kept side by side in one
+// cache-line aligned heap buffer, so a step of 'find' touches one line.
+// A snapshot of it can be loaded by mapping the file (see
+// UnionFindSnapshot.hpp); path compression then writes to private copies of
+// the pages it touches, until the union find grows and moves to the heap.
+class DynamicUnionFind {
+public:
+    explicit DynamicUnionFind(size_t n = 0) {
+        reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            addElement();
+        }
+    }
+
+    virtual ~DynamicUnionFind() noexcept {
+        release();
+    }
+
+    DynamicUnionFind(DynamicUnionFind const& source) {
+        reserve(source.count);
+        memcpy(nodes, source.nodes, sizeof(Node) * source.count);
+        memcpy(next, source.next, sizeof(size_t) * source.count);
+
+        count = source.count;
+        numComponents = source.numComponents;
+    }
+
+    DynamicUnionFind& operator=(DynamicUnionFind const& source) {
+        if (std::addressof(*this) != std::addressof(source)) {
+            reserve(source.count);
+            memcpy(nodes, source.nodes, sizeof(Node) * source.count);
+            memcpy(next, source.next, sizeof(size_t) * source.count);
+
+            count = source.count;
+            numComponents = source.numComponents;
+        }
+
+        return *this;
+    }
+
+    DynamicUnionFind(DynamicUnionFind&& source) noexcept {
+        std::swap(nodes, source.nodes);
+        std::swap(next, source.next);
+        std::swap(count, source.count);
+        std::swap(capacity, source.capacity);
+        std::swap(numComponents, source.numComponents);
+        std::swap(snapshot, source.snapshot);
+    }
+
+    DynamicUnionFind& operator=(DynamicUnionFind&& source) noexcept {
+        std::swap(nodes, source.nodes);
+        std::swap(next, source.next);
+        std::swap(count, source.count);
+        std::swap(capacity, source.capacity);
+        std::swap(numComponents, source.numComponents);
+        std::swap(snapshot, source.snapshot);
+        return *this;
+    }
+
+    // Make room for 'n' elements without reallocating
+    void reserve(size_t n) {
+        if (n <= capacity) return;
+
+        Node* grownNodes = (Node*)non_std::aligned_malloc(sizeof(Node) * n, CACHE_LINE);
+        size_t* grownNext = (size_t*)non_std::aligned_malloc(sizeof(size_t) * n, CACHE_LINE);
+        if (count) {
+            memcpy(grownNodes, nodes, sizeof(Node) * count);
+            memcpy(grownNext, next, sizeof(size_t) * count);
+        }
+
+        release();
+        nodes = grownNodes;
+        next = grownNext;
+        capacity = n;
+    }
+
+    // Add a new element as a component/set of its own, returns its index
+    size_t addElement() {
+        if (count == capacity) {
+            reserve(capacity ? 2 * capacity : 16);
+        }
+
+        nodes[count].id = count; // self-root
+        nodes[count].sz = 1;
+        next[count] = count;
+
+        ++numComponents;
+        return count++;
+    }
+
+    // Find which component/set 'p' belongs to, takes amortized constant time.
+    size_t find(size_t p) noexcept {
+
+        // Find the root of the component/set
+        size_t root = p;
+        while (root != nodes[root].id) root = nodes[root].id;
+
+        // Compress the path leading back to the root.
+        while (nodes[p].id != root) {
+            size_t parent = nodes[p].id;
+            nodes[p].id = root;
+            p = parent;
+        }
+
+        return root;
+    }
+
+    // Return whether or not the elements 'p' and
+    // 'q' are in the same components/set.
+    bool connected(size_t p, size_t q) noexcept {
+        return find(p) == find(q);
+    }
+
+    // Return the size of the component/set 'p' belongs to
+    size_t componentSize(size_t p) noexcept {
+        return nodes[find(p)].sz;
+    }
+
+    // Returns the number of remaining components/sets
+    size_t components() const noexcept {
+        return numComponents;
+    }
+
+    // Returns the number of elements
+    size_t size() const noexcept {
+        return count;
+    }
+
+    // Unify the components/sets containing elements 'p' and 'q'
+    void unify(size_t p, size_t q) noexcept {
+        size_t root1 = find(p);
+        size_t root2 = find(q);
+
+        // These elements are already in the same group
+        if (root1 == root2) return;
+
+        // Merge smaller component/set into the larger one.
+        if (nodes[root1].sz < nodes[root2].sz) {
+            nodes[root2].sz += nodes[root1].sz;
+            nodes[root1].id = root2;
+        }
+        else {
+            nodes[root1].sz += nodes[root2].sz;
+            nodes[root2].id = root1;
+        }
+
+        // Splice the two member cycles into one
+        std::swap(next[root1], next[root2]);
+
+        --numComponents;
+    }
+
+    // Unify the endpoints of 'm' edges, grouped by root for locality
+    void unifyBatch(const Edge* edges, size_t m) {
+        unifyByRoots(*this, edges, m);
+    }
+
+    // Call fn(member) for every member of the component/set 'p' belongs to,
+    // takes time proportional to the size of the component
+    template <typename Fn>
+    void forEachMember(size_t p, Fn&& fn) const {
+        forEachComponentMember(*this, p, std::forward<Fn>(fn));
+    }
+
+    // The member after 'p' in the circular list of its component/set
+    size_t nextMember(size_t p) const noexcept {
+        return next[p];
+    }
+
+    // Label every element with the index of its component/set, numbered
+    // 0..components() - 1 in the order of their smallest elements
+    DynArray<uint32_t> exportLabels() {
+        return labelComponents(*this);
+    }
+
+private:
+    friend struct UnionFindSnapshot;
+
+    static constexpr const size_t CACHE_LINE = 64;
+
+    // Free the nodes, or let go of the snapshot they were mapped from
+    void release() noexcept {
+        if (snapshot) {
+            snapshot.reset();
+        }
+        else {
+            non_std::aligned_free(nodes);
+            non_std::aligned_free(next);
+        }
+    }
+
+    struct Node {
+        // id points to the parent, if id = own index then it is a root node
+        size_t id;
+
+        // Size of the component, only meaningful for root nodes
+        size_t sz;
+    };
+
+    // The number of components in the union find
+    size_t numComponents = 0;
+
+    // The number of elements and the number of allocated nodes
+    size_t count = 0;
+    size_t capacity = 0;
+
+    Node* nodes = nullptr;
+
+    // next[i] is the next member of the component of i, in a circular list
+    size_t* next = nullptr;
+
+    // Mapped file of nodes and next when the union find was loaded
+    std::shared_ptr<non_std::Snapshot> snapshot;
+};
+
+/*int main(void) {
+    size_t n;
+    std::cin >> n;
+
+    DynamicUnionFind uf(n);
+    uf.unify(0, n - 1);
+
+    size_t extra = uf.addElement();
+    uf.unify(extra, 0);
+
+    std::cout << uf.componentSize(n - 1) << " " << uf.components() << std::endl;
+    return 0;
+}*/
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include "../2Arrays/DynArray.hpp"
+
+// An undirected edge between the elements 'from' and 'to'
+struct Edge {
+    size_t from;
+    size_t to;
+};
+
+// Unify the endpoints of 'm' edges in a batch. The roots of all endpoints
+// are found first, then the edges are sorted by root, so that the following
+// unions walk the parent array in order instead of jumping around it.
+template <typename UF>
+void unifyByRoots(UF& uf, const Edge* edges, size_t m) {
+    DynArray<Edge> roots(m);
+
+    for (size_t i = 0; i < m; ++i) {
+        size_t root1 = uf.find(edges[i].from);
+        size_t root2 = uf.find(edges[i].to);
+
+        // Edges inside a component change nothing
+        if (root1 != root2) {
+            roots.add(Edge{std::min(root1, root2), std::max(root1, root2)});
+        }
+    }
+
+    Edge* data = roots.data();
+    std::sort(data, data + roots.size(), [](Edge const& a, Edge const& b) {
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    });
+
+    for (size_t i = 0; i < roots.size(); ++i) {
+        uf.unify(data[i].from, data[i].to);
+    }
+}
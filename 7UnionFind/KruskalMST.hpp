@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include "DynamicUnionFind.hpp"
+#include "../6PriorityQueues/MinPQ.hpp"
+#include "../Headers/Parallel.hpp"
+
+template <typename W>
+struct WeightedEdge {
+    size_t from;
+    size_t to;
+    W weight;
+
+    bool operator<(WeightedEdge const& rhs) const { return weight < rhs.weight; }
+    bool operator>(WeightedEdge const& rhs) const { return weight > rhs.weight; }
+    bool operator==(WeightedEdge const& rhs) const {
+        return from == rhs.from && to == rhs.to && weight == rhs.weight;
+    }
+};
+
+// How the edges are brought into ascending weight order
+enum class KruskalStrategy {
+    HEAP,          // O(m) bulk-built MinPQ, only the edges examined before the early exit are polled
+    SORT,          // std::sort of a copy of the edges
+    PARALLEL_SORT  // Parallel sort of a copy of the edges
+};
+
+// Kruskal's minimum spanning tree (a minimum spanning forest if the graph is
+// not connected). Edges are walked in ascending weight and taken whenever they
+// join two components, stopping as soon as one component is left.
+template <typename W>
+class KruskalMST {
+public:
+    KruskalMST(size_t n, const WeightedEdge<W>* edges, size_t m,
+               KruskalStrategy strategy = KruskalStrategy::PARALLEL_SORT,
+               unsigned threads = non_std::hardware_threads()) :
+        uf(n),
+        tree(n ? n - 1 : 1)
+    {
+        switch (strategy) {
+            case KruskalStrategy::HEAP: {
+                MinPQ<WeightedEdge<W>> pq(edges, m);
+                while (pq.size() && uf.components() > 1) {
+                    take(pq.poll().fromJust());
+                }
+
+                break;
+            }
+
+            case KruskalStrategy::SORT:
+            case KruskalStrategy::PARALLEL_SORT: {
+                DynArray<WeightedEdge<W>> sorted(m);
+                sorted.append(edges, m);
+
+                WeightedEdge<W>* data = sorted.data();
+                auto byWeight = [](WeightedEdge<W> const& a, WeightedEdge<W> const& b) {
+                    return a.weight < b.weight;
+                };
+
+                if (strategy == KruskalStrategy::PARALLEL_SORT) {
+                    non_std::parallel_sort(data, data + m, threads, byWeight);
+                }
+                else {
+                    std::sort(data, data + m, byWeight);
+                }
+
+                for (size_t i = 0; i < m && uf.components() > 1; ++i) {
+                    take(data[i]);
+                }
+
+                break;
+            }
+        }
+    }
+
+    virtual ~KruskalMST() = default;
+
+    // The edges of the tree, in ascending weight
+    DynArray<WeightedEdge<W>> const& edges() const noexcept {
+        return tree;
+    }
+
+    // Total weight of the tree
+    W cost() const noexcept {
+        return total;
+    }
+
+    // Whether or not the tree spans every vertex
+    bool isSpanning() const noexcept {
+        return uf.components() <= 1;
+    }
+
+    // The number of trees in the spanning forest
+    size_t components() const noexcept {
+        return uf.components();
+    }
+
+private:
+    void take(WeightedEdge<W> const& e) {
+        size_t root1 = uf.find(e.from);
+        size_t root2 = uf.find(e.to);
+        if (root1 == root2) return;
+
+        uf.unify(root1, root2);
+        tree.add(e);
+        total += e.weight;
+    }
+
+    DynamicUnionFind uf;
+
+    DynArray<WeightedEdge<W>> tree;
+
+    W total = W();
+};
+
+/*#include <chrono>
+#include <random>
+#include <vector>
+
+void bench(const char* graph, size_t n, std::vector<WeightedEdge<double>> const& edges) {
+    const char* const names[] = {"HEAP", "SORT", "PARALLEL_SORT"};
+    const KruskalStrategy strategies[] = {KruskalStrategy::HEAP, KruskalStrategy::SORT, KruskalStrategy::PARALLEL_SORT};
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        KruskalMST<double> mst(n, edges.data(), edges.size(), strategies[i]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << graph << " / " << names[i] << ": " << seconds << "s, cost " << mst.cost() << std::endl;
+    }
+}
+
+int main(void) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> weight(0, 1);
+
+    // 10^7 edges over random vertex pairs
+    {
+        const size_t n = 1000000;
+        std::vector<WeightedEdge<double>> edges(10000000);
+        for (auto& e : edges) e = WeightedEdge<double>{rng() % n, rng() % n, weight(rng)};
+
+        bench("random", n, edges);
+    }
+
+    // ~10^7 edges of a 2236 x 2236 grid
+    {
+        const size_t side = 2236;
+        std::vector<WeightedEdge<double>> edges;
+        edges.reserve(2 * side * side);
+
+        for (size_t r = 0; r < side; ++r) {
+            for (size_t c = 0; c < side; ++c) {
+                if (c + 1 < side) edges.push_back(WeightedEdge<double>{r * side + c, r * side + c + 1, weight(rng)});
+                if (r + 1 < side) edges.push_back(WeightedEdge<double>{r * side + c, (r + 1) * side + c, weight(rng)});
+            }
+        }
+
+        bench("grid", side * side, edges);
+    }
+
+    return 0;
+}*/
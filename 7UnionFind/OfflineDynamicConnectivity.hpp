@@ -0,0 +1,189 @@
+#pragma once
+
+#include <map>
+#include <utility>
+#include "RollbackUnionFind.hpp"
+
+// Answers connectivity queries over a graph whose edges appear and disappear,
+// when the whole sequence of operations is known up front.
+//
+// Every edge is alive during an interval of operations. The intervals are put
+// into a segment tree over time: each one lands in O(log(q)) nodes. A depth
+// first walk of the tree unifies the edges of a node on the way down and rolls
+// them back on the way up, so at every leaf the RollbackUnionFind holds exactly
+// the edges alive at that moment. The total running time is O((n + q) log^2(n)).
+class OfflineDynamicConnectivity {
+public:
+    explicit OfflineDynamicConnectivity(size_t n) : vertices(n) {}
+
+    virtual ~OfflineDynamicConnectivity() = default;
+
+    void addEdge(size_t u, size_t v) {
+        ops.add(Operation{Kind::ADD, u, v});
+    }
+
+    // Removing an edge which is not in the graph does nothing
+    void removeEdge(size_t u, size_t v) {
+        ops.add(Operation{Kind::REMOVE, u, v});
+    }
+
+    // Ask whether 'u' and 'v' are connected at this point of the sequence
+    void query(size_t u, size_t v) {
+        ops.add(Operation{Kind::QUERY, u, v});
+        ++queries;
+    }
+
+    // Answers to all queries, in the order they were asked
+    DynArray<bool> solve() {
+        DynArray<bool> answers(queries);
+        size_t q = ops.size();
+        if (!q) return answers;
+
+        // Pair up additions with removals of the same edge into alive intervals
+        std::map<std::pair<size_t, size_t>, DynArray<size_t>> open;
+        DynArray<Interval> intervals;
+
+        for (size_t t = 0; t < q; ++t) {
+            Operation const& op = ops.data()[t];
+            std::pair<size_t, size_t> key(std::min(op.u, op.v), std::max(op.u, op.v));
+
+            if (op.kind == Kind::ADD) {
+                open[key].add(t);
+            }
+            else if (op.kind == Kind::REMOVE) {
+                auto it = open.find(key);
+                if (it == open.end() || !it->second.size()) continue;
+
+                DynArray<size_t>& starts = it->second;
+                intervals.add(Interval{starts.data()[starts.size() - 1], t, Edge{key.first, key.second}});
+                starts.resize(starts.size() - 1);
+            }
+        }
+
+        for (auto& entry : open) {
+            for (size_t i = 0; i < entry.second.size(); ++i) {
+                intervals.add(Interval{entry.second.data()[i], q, Edge{entry.first.first, entry.first.second}});
+            }
+        }
+
+        // Segment tree node edge lists, flattened into one array by counting sort
+        size_t leaves = 1;
+        while (leaves < q) leaves *= 2;
+
+        DynArray<Placement> placements;
+        for (size_t i = 0; i < intervals.size(); ++i) {
+            Interval const& iv = intervals.data()[i];
+            place(1, 0, leaves, iv.begin, iv.end, iv.edge, placements);
+        }
+
+        offsets.resize(2 * leaves + 1);
+        std::fill(offsets.data(), offsets.data() + offsets.size(), 0);
+
+        for (size_t i = 0; i < placements.size(); ++i) {
+            ++offsets.data()[placements.data()[i].node + 1];
+        }
+
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            offsets.data()[i] += offsets.data()[i - 1];
+        }
+
+        nodeEdges.resize(placements.size());
+
+        DynArray<size_t> fill(offsets);
+        for (size_t i = 0; i < placements.size(); ++i) {
+            Placement const& p = placements.data()[i];
+            nodeEdges.data()[fill.data()[p.node]++] = p.edge;
+        }
+
+        RollbackUnionFind uf(vertices);
+        walk(1, 0, leaves, uf, answers);
+        return answers;
+    }
+
+private:
+    enum class Kind { ADD, REMOVE, QUERY };
+
+    struct Operation {
+        Kind kind;
+        size_t u;
+        size_t v;
+    };
+
+    // 'edge' is alive for operations in [begin, end)
+    struct Interval {
+        size_t begin;
+        size_t end;
+        Edge edge;
+    };
+
+    struct Placement {
+        size_t node;
+        Edge edge;
+    };
+
+    // Put the interval [l, r) into the nodes which cover it exactly
+    static void place(size_t node, size_t lo, size_t hi, size_t l, size_t r, Edge const& edge, DynArray<Placement>& out) {
+        if (r <= lo || hi <= l) return;
+
+        if (l <= lo && hi <= r) {
+            out.add(Placement{node, edge});
+            return;
+        }
+
+        size_t mid = (lo + hi) / 2;
+        place(2 * node, lo, mid, l, r, edge, out);
+        place(2 * node + 1, mid, hi, l, r, edge, out);
+    }
+
+    void walk(size_t node, size_t lo, size_t hi, RollbackUnionFind& uf, DynArray<bool>& answers) {
+        if (lo >= ops.size()) return;
+
+        size_t before = uf.snapshot();
+
+        for (size_t i = offsets.data()[node]; i < offsets.data()[node + 1]; ++i) {
+            uf.unify(nodeEdges.data()[i].from, nodeEdges.data()[i].to);
+        }
+
+        if (hi - lo == 1) {
+            Operation const& op = ops.data()[lo];
+            if (op.kind == Kind::QUERY) {
+                answers.add(uf.connected(op.u, op.v));
+            }
+        }
+        else {
+            size_t mid = (lo + hi) / 2;
+            walk(2 * node, lo, mid, uf, answers);
+            walk(2 * node + 1, mid, hi, uf, answers);
+        }
+
+        uf.rollback(before);
+    }
+
+    // The number of vertices of the graph
+    size_t vertices;
+
+    // The number of queries asked
+    size_t queries = 0;
+
+    DynArray<Operation> ops;
+
+    // Edges of node i are nodeEdges[offsets[i] .. offsets[i + 1])
+    DynArray<size_t> offsets;
+    DynArray<Edge> nodeEdges;
+};
+
+/*int main(void) {
+    OfflineDynamicConnectivity dc(4);
+
+    dc.addEdge(0, 1);
+    dc.addEdge(1, 2);
+    dc.query(0, 2);     // 1
+    dc.removeEdge(0, 1);
+    dc.query(0, 2);     // 0
+    dc.addEdge(2, 3);
+    dc.addEdge(3, 0);
+    dc.query(0, 1);     // 1
+
+    std::cout << dc.solve() << std::endl;
+    return 0;
+}*/
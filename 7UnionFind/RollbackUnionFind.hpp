@@ -0,0 +1,123 @@
+#pragma once
+
+#include <iostream>
+#include "Edge.hpp"
+#include "../2Arrays/DynArray.hpp"
+#include "../Headers/NonSTD.hpp"
+
+// Union find whose unions can be undone in reverse order. There is no path
+// compression, as that would rewrite parents which the undo log does not know
+// about; union by size alone keeps every tree O(log(n)) deep, so 'find' takes
+// O(log(n)) time and undoing a union takes O(1).
+class RollbackUnionFind {
+public:
+    explicit RollbackUnionFind(size_t n) :
+        numComponents(n),
+        count(n),
+        id(non_std::make_unique<size_t[]>(n ? n : 1)),
+        sz(non_std::make_unique<size_t[]>(n ? n : 1))
+    {
+        for (size_t i = 0; i < n; ++i) {
+            id[i] = i; // self-root
+            sz[i] = 1;
+        }
+    }
+
+    virtual ~RollbackUnionFind() = default;
+
+    // Find which component/set 'p' belongs to, takes O(log(n)) time.
+    size_t find(size_t p) const noexcept {
+        while (p != id[p]) p = id[p];
+        return p;
+    }
+
+    // Return whether or not the elements 'p' and
+    // 'q' are in the same components/set.
+    bool connected(size_t p, size_t q) const noexcept {
+        return find(p) == find(q);
+    }
+
+    // Return the size of the component/set 'p' belongs to
+    size_t componentSize(size_t p) const noexcept {
+        return sz[find(p)];
+    }
+
+    // Returns the number of remaining components/sets
+    size_t components() const noexcept {
+        return numComponents;
+    }
+
+    // Returns the number of elements
+    size_t size() const noexcept {
+        return count;
+    }
+
+    // Unify the components/sets containing elements 'p' and 'q',
+    // returns whether or not they were separate before.
+    bool unify(size_t p, size_t q) noexcept {
+        size_t root1 = find(p);
+        size_t root2 = find(q);
+
+        // These elements are already in the same group
+        if (root1 == root2) return false;
+
+        // Merge smaller component/set into the larger one.
+        if (sz[root1] < sz[root2]) std::swap(root1, root2);
+
+        sz[root1] += sz[root2];
+        id[root2] = root1;
+
+        history.add(root2);
+        --numComponents;
+        return true;
+    }
+
+    // A point to roll back to, every union made after it can be undone
+    size_t snapshot() const noexcept {
+        return history.size();
+    }
+
+    // Undo every union made since the snapshot 'to' was taken
+    void rollback(size_t to) noexcept {
+        while (history.size() > to) {
+            size_t child = history.data()[history.size() - 1];
+            size_t root = id[child];
+
+            sz[root] -= sz[child];
+            id[child] = child;
+
+            history.resize(history.size() - 1);
+            ++numComponents;
+        }
+    }
+
+private:
+    // The number of components in the union find
+    size_t numComponents;
+
+    // The number of elements
+    size_t count;
+
+    // id[i] points to the parent of i, if id[i] = i then i is a root node
+    std::unique_ptr<size_t[]> id;
+
+    // Used to track the size of each of the component
+    std::unique_ptr<size_t[]> sz;
+
+    // Undo log: roots which got hung under another root, oldest first
+    DynArray<size_t> history;
+};
+
+/*int main(void) {
+    RollbackUnionFind uf(10);
+    uf.unify(1, 2);
+
+    size_t before = uf.snapshot();
+    uf.unify(2, 3);
+    uf.unify(6, 9);
+    std::cout << uf.connected(1, 3) << " " << uf.components() << std::endl;
+
+    uf.rollback(before);
+    std::cout << uf.connected(1, 3) << " " << uf.components() << std::endl;
+    return 0;
+}*/
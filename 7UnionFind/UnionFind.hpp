@@ -1,7 +1,16 @@
 #pragma once
 
 #include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "Components.hpp"
+#include "Edge.hpp"
+#include "../2Arrays/DynArray.hpp"
 
+struct UnionFindSnapshot;
+
+// Saved and loaded through UnionFindSnapshot.hpp
 template <size_t n>
 class UnionFind {
     static_assert(n > 0, "Size must be natural");
@@ -11,6 +20,7 @@ public:
         for (size_t i = 0; i < n; ++i) {
             id[i] = i; // self-root
             sz[i] = 1;
+            next[i] = i;
         }
     }
 
@@ -27,9 +37,9 @@ public:
         // Doing this operation is called "path compression"
         // and is what gives us amortized time complexity.
         while (id[p] != root) {
-            size_t next = id[p];
+            size_t parent = id[p];
             id[p] = root;
-            p = next;
+            p = parent;
         }
 
         return root;
@@ -51,6 +61,11 @@ public:
         return numComponents;
     }
 
+    // Returns the number of elements
+    size_t size() const noexcept {
+        return n;
+    }
+
     // Unify the components/sets containing elements 'p' and 'q'
     void unify(size_t p, size_t q) noexcept {
         size_t root1 = find(p);
@@ -69,10 +84,37 @@ public:
             id[root2] = root1;
         }
 
+        // Splice the two member cycles into one
+        std::swap(next[root1], next[root2]);
+
         --numComponents;
     }
 
+    // Unify the endpoints of 'm' edges, grouped by root for locality
+    void unifyBatch(const Edge* edges, size_t m) {
+        unifyByRoots(*this, edges, m);
+    }
+
+    // Call fn(member) for every member of the component/set 'p' belongs to,
+    // takes time proportional to the size of the component
+    template <typename Fn>
+    void forEachMember(size_t p, Fn&& fn) const {
+        forEachComponentMember(*this, p, std::forward<Fn>(fn));
+    }
+
+    // The member after 'p' in the circular list of its component/set
+    size_t nextMember(size_t p) const noexcept {
+        return next[p];
+    }
+
+    // Label every element with the index of its component/set, numbered
+    // 0..components() - 1 in the order of their smallest elements
+    DynArray<uint32_t> exportLabels() {
+        return labelComponents(*this);
+    }
+
 private:
+    friend struct UnionFindSnapshot;
 
     // The number of components in the union find
     size_t numComponents = n;
@@ -82,6 +124,9 @@ private:
 
     // id[i] points to the parent of i, if id[i] = i then i is a root node
     size_t id[n];
+
+    // next[i] is the next member of the component of i, in a circular list
+    size_t next[n];
 };
 
 /*int main(void) {
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "DynamicUnionFind.hpp"
+#include "UnionFind.hpp"
+#include "../Headers/Snapshot.hpp"
+
+// Snapshots of union finds, kept apart from the union finds so that they do
+// not depend on file mapping. This is the one place allowed into their
+// arrays; use the free functions below.
+struct UnionFindSnapshot {
+    // Write the elements to a snapshot file
+    template <size_t n>
+    static void save(UnionFind<n> const& uf, std::string const& path) {
+        uint64_t meta[2] = {n, uf.numComponents};
+
+        non_std::SnapshotWriter writer(path, non_std::SnapshotKind::UNION_FIND, sizeof(size_t));
+        writer.section(meta, sizeof(meta));
+        writer.section(uf.id, sizeof(uf.id));
+        writer.section(uf.sz, sizeof(uf.sz));
+        writer.section(uf.next, sizeof(uf.next));
+        writer.close();
+    }
+
+    // Replace the elements with a saved union find of the same size. The
+    // arrays live inside the object, so they are copied out of the mapping;
+    // loading a DynamicUnionFind serves straight from it.
+    template <size_t n>
+    static void load(UnionFind<n>& uf, std::string const& path) {
+        non_std::Snapshot source(path, non_std::SnapshotKind::UNION_FIND, sizeof(size_t), non_std::SnapshotCheck::NOW);
+
+        const uint64_t* meta = source.section<uint64_t>(0, 2);
+        if (meta[0] != n) {
+            throw std::runtime_error("Snapshot holds a union find of a different size");
+        }
+
+        memcpy(uf.id, source.section<size_t>(1, n), sizeof(uf.id));
+        memcpy(uf.sz, source.section<size_t>(2, n), sizeof(uf.sz));
+        memcpy(uf.next, source.section<size_t>(3, n), sizeof(uf.next));
+        uf.numComponents = meta[1];
+    }
+
+    // Write the elements to a snapshot file
+    static void save(DynamicUnionFind const& uf, std::string const& path) {
+        Meta meta = {uf.count, uf.numComponents};
+
+        non_std::SnapshotWriter writer(path, non_std::SnapshotKind::DYNAMIC_UNION_FIND, sizeof(DynamicUnionFind::Node));
+        writer.section(&meta, sizeof(meta));
+        writer.section(uf.nodes, sizeof(DynamicUnionFind::Node) * uf.count);
+        writer.section(uf.next, sizeof(size_t) * uf.count);
+        writer.close();
+    }
+
+    // Map a saved union find, nothing is copied. Path compression writes to
+    // the mapping, so the checksum is verified before this returns.
+    static DynamicUnionFind load(std::string const& path) {
+        typedef DynamicUnionFind::Node Node;
+
+        auto source = std::make_shared<non_std::Snapshot>(path, non_std::SnapshotKind::DYNAMIC_UNION_FIND,
+                                                          sizeof(Node), non_std::SnapshotCheck::NOW);
+
+        Meta const& meta = *source->section<Meta>(0, 1);
+
+        DynamicUnionFind uf;
+        uf.nodes = source->section<Node>(1, meta.count);
+        uf.next = source->section<size_t>(2, meta.count);
+        uf.count = uf.capacity = meta.count;
+        uf.numComponents = meta.numComponents;
+        uf.snapshot = std::move(source);
+        return uf;
+    }
+
+private:
+    struct Meta {
+        uint64_t count;
+        uint64_t numComponents;
+    };
+};
+
+template <size_t n>
+void saveUnionFind(UnionFind<n> const& uf, std::string const& path) {
+    UnionFindSnapshot::save(uf, path);
+}
+
+template <size_t n>
+void loadUnionFind(UnionFind<n>& uf, std::string const& path) {
+    UnionFindSnapshot::load(uf, path);
+}
+
+inline void saveUnionFind(DynamicUnionFind const& uf, std::string const& path) {
+    UnionFindSnapshot::save(uf, path);
+}
+
+inline DynamicUnionFind loadDynamicUnionFind(std::string const& path) {
+    return UnionFindSnapshot::load(path);
+}
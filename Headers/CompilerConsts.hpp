@@ -13,3 +13,31 @@ template <typename T, size_t n>
 constexpr size_t array_size(const T(&)[n]) {
     return n;
 }
+
+// Promise that a pointer is the only way its data is reached in a scope,
+// which lets loops over several arrays vectorize without alias checks
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+    #define RESTRICT __restrict
+#else
+    #define RESTRICT
+#endif
+
+// Index of the highest set bit, value must be positive
+inline unsigned floor_log2(unsigned long long value) noexcept {
+    #if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+    #else
+    unsigned result = 0;
+    while (value >>= 1) ++result;
+    return result;
+    #endif
+}
+
+// Hint that the cache line holding 'addr' will soon be read
+inline void prefetch_read(const void* addr) noexcept {
+    #if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr, 0, 3);
+    #else
+    (void)addr;
+    #endif
+}
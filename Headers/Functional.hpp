@@ -4,60 +4,104 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
+#include <utility>
 #include "NonSTD.hpp"
 
 using std::function;
 using std::vector;
 
+// Functors and monads over any callable: the combinators take the callable
+// as a deduced template parameter and forward their arguments, so that a
+// pipeline built from them is a direct call the compiler can inline, rather
+// than a chain of type-erased std::function calls.
+
+namespace functional_detail {
+    // What 'Fn' returns for an argument 'A', without references or const
+    template <typename Fn, typename A>
+    using result_t = typename std::decay<decltype(std::declval<Fn&>()(std::declval<A>()))>::type;
+
+    // Ignores its argument and returns a copy of 'value'
+    template <typename T>
+    struct constant {
+        T const& value;
+
+        template <typename A>
+        T operator()(A&&) const {
+            return value;
+        }
+    };
+}
+
+// Specializations provide 'fmap(f, fa)' for F<A> const&. They may also take
+// F<A>&& and reuse its storage when f maps A to A.
 template <template <typename...> class F>
-struct Functor {
-    template <typename A, typename B>
-    static function <F<B>(F<A>)> fmap(function <B(A)>);
+struct Functor;
+
+// 'f' lifted to act on F<A>, as returned by fmap<F>(f)
+template <template <typename...> class F, typename Fn>
+class Lifted {
+public:
+    explicit Lifted(Fn fn) : f(std::move(fn)) {}
+
+    template <typename FA>
+    auto operator()(FA&& fa) const -> decltype(Functor<F>::fmap(std::declval<Fn const&>(), std::forward<FA>(fa))) {
+        return Functor<F>::fmap(f, std::forward<FA>(fa));
+    }
+
+private:
+    Fn f;
 };
 
-template <template <typename...> class F, typename A, typename B>
-static function <F<B>(F<A>)> fmap(function <B(A)> f) {
-    return Functor<F>::fmap(f);
+template <template <typename...> class F, typename Fn>
+Lifted<F, typename std::decay<Fn>::type> fmap(Fn&& f) {
+    return Lifted<F, typename std::decay<Fn>::type>(std::forward<Fn>(f));
 }
 
-template <template <typename...> class F, typename A, typename B>
-static F<B> fmap_(function <B(A)> f, F<A> const& v) {
-    return Functor<F>::fmap(f)(v);
+template <typename Fn, template <typename...> class F, typename... Args>
+auto fmap_(Fn&& f, F<Args...> const& v) -> decltype(Functor<F>::fmap(std::forward<Fn>(f), v)) {
+    return Functor<F>::fmap(std::forward<Fn>(f), v);
 }
 
-template <template <typename...> class F, typename A, typename B>
-static F<B> operator %(function <B(A)> f, F<A> const& v) {
-    return Functor<F>::fmap(f)(v);
+template <typename Fn, template <typename...> class F, typename... Args>
+auto fmap_(Fn&& f, F<Args...>&& v) -> decltype(Functor<F>::fmap(std::forward<Fn>(f), std::move(v))) {
+    return Functor<F>::fmap(std::forward<Fn>(f), std::move(v));
 }
 
-template <template <typename...> class F>
-struct Monad {
-    template <typename A>
-    static F<A> return_(A const&);
-
-    template <typename A, typename B>
-    static F<B> bind(F<A> const&, function<F<B>(A)>);
-};
+template <typename Fn, template <typename...> class F, typename... Args>
+auto operator%(Fn&& f, F<Args...> const& v) -> decltype(Functor<F>::fmap(std::forward<Fn>(f), v)) {
+    return Functor<F>::fmap(std::forward<Fn>(f), v);
+}
 
-template <template <typename...> class F, typename A, typename B>
-static F<B> bind(F<A> const& m, function<F<B>(A)> f) {
-    return Monad<F>::bind(m, f);
+template <typename Fn, template <typename...> class F, typename... Args>
+auto operator%(Fn&& f, F<Args...>&& v) -> decltype(Functor<F>::fmap(std::forward<Fn>(f), std::move(v))) {
+    return Functor<F>::fmap(std::forward<Fn>(f), std::move(v));
 }
 
+// Specializations provide 'return_(a)' and 'bind(m, f)'
+template <template <typename...> class F>
+struct Monad;
+
 template <template <typename...> class F, typename A>
-static F<A> return_(A const& a) {
-    return Monad<F>::return_(a);
+auto return_(A&& a) -> decltype(Monad<F>::return_(std::forward<A>(a))) {
+    return Monad<F>::return_(std::forward<A>(a));
 }
 
-template <template <typename...> class F, typename A, typename B>
-static F<B> operator>=(F<A> const& m, function<F<B>(A)> f) {
-    return Monad<F>::bind(m, f);
+template <template <typename...> class F, typename... Args, typename Fn>
+auto bind(F<Args...> const& m, Fn&& f) -> decltype(Monad<F>::bind(m, std::forward<Fn>(f))) {
+    return Monad<F>::bind(m, std::forward<Fn>(f));
 }
 
-template <template <typename...> class F, typename A, typename B>
-static F<B> operator>>(F<A> const& a, F<B> const& b) {
-    function<F<B>(A)> f = [b](A) { return b; };
-    return a >= f;
+template <template <typename...> class F, typename... Args, typename Fn>
+auto operator>=(F<Args...> const& m, Fn&& f) -> decltype(Monad<F>::bind(m, std::forward<Fn>(f))) {
+    return Monad<F>::bind(m, std::forward<Fn>(f));
+}
+
+template <template <typename...> class F, typename... As, typename... Bs>
+auto operator>>(F<As...> const& a, F<Bs...> const& b)
+    -> decltype(Monad<F>::bind(a, functional_detail::constant<F<Bs...>>{b})) {
+
+    return Monad<F>::bind(a, functional_detail::constant<F<Bs...>>{b});
 }
 
 template <typename T>
@@ -129,29 +173,30 @@ private:
 
 template <>
 struct Functor<Maybe> {
-    template <typename A, typename B>
-    static function <Maybe<B>(Maybe<A>)> fmap(function <B(A)> f) {
-        return [f](Maybe<A> m) -> Maybe<B> {
-            if (m.isNothing()) {
-                return Maybe<B>();
-            } else {
-                return Maybe<B>(f(m.fromJust()));
-            }
-        };
-    };
+    // Copies of a Maybe share their value, so it is never updated in place
+    template <typename Fn, typename A>
+    static Maybe<functional_detail::result_t<Fn, A const&>> fmap(Fn&& f, Maybe<A> const& m) {
+        typedef functional_detail::result_t<Fn, A const&> B;
+
+        if (m.isNothing()) {
+            return Maybe<B>();
+        }
+
+        return Maybe<B>(f(m.fromJust()));
+    }
 };
 
 template <>
 struct Monad<Maybe> {
     template <typename A>
-    static Maybe<A> return_(A const& v) {
-        return Maybe<A>(v);
+    static Maybe<typename std::decay<A>::type> return_(A&& v) {
+        return Maybe<typename std::decay<A>::type>(std::forward<A>(v));
     }
 
-    template <typename A, typename B>
-    static Maybe<B> bind(Maybe<A> const& m, function<Maybe<B>(A)> f) {
+    template <typename A, typename Fn>
+    static auto bind(Maybe<A> const& m, Fn&& f) -> decltype(f(m.fromJust())) {
         if (m.isNothing()) {
-            return Maybe<B>();
+            return decltype(f(m.fromJust()))();
         }
 
         return f(m.fromJust());
@@ -160,23 +205,60 @@ struct Monad<Maybe> {
 
 template <>
 struct Functor<vector> {
-    template <typename A, typename B>
-    static function <vector<B>(vector<A>)> fmap(function <B(A)> f) {
-        return [f](vector<A> v) {
-            vector<B> result;
-            result.reserve(v.size());
-
-            std::transform(v.begin(), v.end(), std::back_inserter(result), f);
-            return result;
-        };
+    template <typename Fn, typename A, typename Alloc>
+    static vector<functional_detail::result_t<Fn, A const&>> fmap(Fn&& f, vector<A, Alloc> const& v) {
+        vector<functional_detail::result_t<Fn, A const&>> result;
+        result.reserve(v.size());
+
+        for (A const& a : v) {
+            result.push_back(f(a));
+        }
+
+        return result;
+    }
+
+    // A vector about to be dropped is mapped over in place when f maps A to A
+    template <typename Fn, typename A, typename Alloc>
+    static auto fmap(Fn&& f, vector<A, Alloc>&& v)
+        -> typename std::enable_if<std::is_same<functional_detail::result_t<Fn, A&&>, A>::value, vector<A, Alloc>>::type {
+
+        for (A& a : v) {
+            a = f(std::move(a));
+        }
+
+        return std::move(v);
+    }
+
+    template <typename Fn, typename A, typename Alloc>
+    static auto fmap(Fn&& f, vector<A, Alloc>&& v)
+        -> typename std::enable_if<!std::is_same<functional_detail::result_t<Fn, A&&>, A>::value,
+                                   vector<functional_detail::result_t<Fn, A const&>>>::type {
+
+        return fmap(std::forward<Fn>(f), static_cast<vector<A, Alloc> const&>(v));
     }
 };
 
-template <typename A, typename B, typename C>
-static function<C(A)> compose(function<B(A)> f1, function<C(B)> f2) {
-    return [f1, f2](A v) -> C {
-        return f2(f1(v));
-    };
+// f2 after f1
+template <typename F1, typename F2>
+class Composed {
+public:
+    Composed(F1 first, F2 second) : f1(std::move(first)), f2(std::move(second)) {}
+
+    template <typename... Args>
+    auto operator()(Args&&... args) const
+        -> decltype(std::declval<F2 const&>()(std::declval<F1 const&>()(std::forward<Args>(args)...))) {
+
+        return f2(f1(std::forward<Args>(args)...));
+    }
+
+private:
+    F1 f1;
+    F2 f2;
+};
+
+template <typename F1, typename F2>
+Composed<typename std::decay<F1>::type, typename std::decay<F2>::type> compose(F1&& f1, F2&& f2) {
+    return Composed<typename std::decay<F1>::type, typename std::decay<F2>::type>(std::forward<F1>(f1), std::forward<F2>(f2));
 }
 
 #if __cplusplus > 201103L
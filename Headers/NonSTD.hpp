@@ -1,5 +1,8 @@
 #pragma once
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <new>
 #include <string>
 
 namespace non_std {
@@ -7,14 +10,14 @@ namespace non_std {
 
     // Constructable objects
     template<typename T, typename... Args>
-    typename std::enable_if<std::is_constructible<T, Args...>::value, std::unique_ptr<T>>::type
+    typename std::enable_if<!std::is_array<T>::value && std::is_constructible<T, Args...>::value, std::unique_ptr<T>>::type
     make_unique(Args&&... args) {
         return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
     }
 
     // Structures brace init
     template<typename T, typename... Args>
-    typename std::enable_if<!std::is_constructible<T, Args...>::value, std::unique_ptr<T>>::type
+    typename std::enable_if<!std::is_array<T>::value && !std::is_constructible<T, Args...>::value, std::unique_ptr<T>>::type
     make_unique(Args&&... args) {
         return std::unique_ptr<T>(new T{std::forward<Args>(args)...});
     }
@@ -26,6 +29,27 @@ namespace non_std {
         return std::unique_ptr<T>(new typename std::remove_extent<T>::type[size]);
     }
 
+    // ---- Over-aligned heap storage (C++17 aligned new is not available)
+
+    // 'alignment' must be a power of 2
+    inline void* aligned_malloc(size_t size, size_t alignment) {
+        void* raw = malloc(size + alignment - 1 + sizeof(void*));
+        if (raw == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        // Keep the pointer returned by malloc right in front of the aligned block
+        uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        ((void**)aligned)[-1] = raw;
+        return (void*)aligned;
+    }
+
+    inline void aligned_free(void* ptr) noexcept {
+        if (ptr != nullptr) {
+            free(((void**)ptr)[-1]);
+        }
+    }
+
     // ---- Support for std::to_string overloading
     namespace adl_helper {
         using std::to_string;
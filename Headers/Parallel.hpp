@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace non_std {
+    // ---- Fork-join helpers over std::thread
+
+    inline unsigned hardware_threads() noexcept {
+        unsigned threads = std::thread::hardware_concurrency();
+        return threads ? threads : 1;
+    }
+
+    // Split [begin, end) into one contiguous chunk per thread and call fn(chunkBegin, chunkEnd)
+    // on each of them. The calling thread takes the first chunk.
+    template <typename Fn>
+    void parallel_for(size_t begin, size_t end, unsigned threads, Fn&& fn) {
+        size_t len = end - begin;
+        if (threads <= 1 || len < 2) {
+            fn(begin, end);
+            return;
+        }
+
+        if (threads > len) threads = unsigned(len);
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+
+        for (unsigned t = 1; t < threads; ++t) {
+            size_t lo = begin + len * t / threads;
+            size_t hi = begin + len * (t + 1) / threads;
+            workers.emplace_back([&fn, lo, hi]() { fn(lo, hi); });
+        }
+
+        fn(begin, begin + len / threads);
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Sort one chunk per thread, then merge neighbouring chunks pairwise, also in parallel
+    template <typename T, typename Compare>
+    void parallel_sort(T* first, T* last, unsigned threads, Compare comp) {
+        size_t len = last - first;
+        if (threads <= 1 || len < 2 * threads) {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        std::vector<size_t> bounds(threads + 1);
+        for (unsigned t = 0; t <= threads; ++t) {
+            bounds[t] = len * t / threads;
+        }
+
+        parallel_for(0, threads, threads, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                std::sort(first + bounds[t], first + bounds[t + 1], comp);
+            }
+        });
+
+        for (size_t width = 1; width < threads; width *= 2) {
+            size_t merges = (threads + 2 * width - 1) / (2 * width);
+
+            parallel_for(0, merges, unsigned(merges), [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; ++k) {
+                    size_t lo = 2 * width * k;
+                    size_t mid = std::min<size_t>(lo + width, threads);
+                    size_t hi = std::min<size_t>(lo + 2 * width, threads);
+
+                    if (mid < hi) {
+                        std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], comp);
+                    }
+                }
+            });
+        }
+    }
+}
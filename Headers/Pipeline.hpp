@@ -0,0 +1,527 @@
+#pragma once
+
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "Functional.hpp"
+#include "NonSTD.hpp"
+#include "Parallel.hpp"
+#include "../2Arrays/DynArray.hpp"
+
+namespace pipeline {
+    // ---- Lazy pipelines over the containers
+    //
+    //   view(values) | map(f) | filter(p) | take(k) | collect<DynArray>()
+    //
+    // Nothing runs until the pipeline is collected. Each stage wraps the sink
+    // of the next one, so the whole pipeline is a single loop over the source
+    // with every stage inlined into it, and no container is built in between.
+    // Sources push their values into a sink until it returns false, which is
+    // how take(k) stops a source early.
+    //
+    // Sources:
+    //   view(c)   Anything with data() and size() (DynArray and the heaps
+    //             built on it, vector), or a linked list, Stack or Queue.
+    //             Arrays hand their values to the stages by reference, while
+    //             the list iterators only give out copies through extract(),
+    //             so views of lists copy every value once on the way.
+    //   view(p, n)  The n values from p
+    //   drain(c)  Polls c until it is empty, such as MinPQ, MaxPQ or Queue.
+    //             Values stopped at by take(k) are left in c.
+    //
+    // Views borrow their containers, which must outlive them.
+
+    namespace detail {
+        template <typename...>
+        struct make_void { typedef void type; };
+
+        template <typename C, typename = void>
+        struct has_data : std::false_type {};
+
+        template <typename C>
+        struct has_data<C, typename make_void<decltype(std::declval<C const&>().data()),
+                                              decltype(std::declval<C const&>().size())>::type> : std::true_type {};
+
+        // DoublyLinkedList and Queue
+        template <typename C, typename = void>
+        struct has_fd_iter : std::false_type {};
+
+        template <typename C>
+        struct has_fd_iter<C, typename make_void<decltype(std::declval<C const&>().fd_iter())>::type> : std::true_type {};
+
+        // SinglyLinkedList and Stack
+        template <typename C, typename = void>
+        struct has_iter : std::false_type {};
+
+        template <typename C>
+        struct has_iter<C, typename make_void<decltype(std::declval<C const&>().iter())>::type> : std::true_type {};
+
+        // Appending to the collected container
+        template <typename C, typename = void>
+        struct has_push_back : std::false_type {};
+
+        template <typename C>
+        struct has_push_back<C, typename make_void<decltype(std::declval<C&>().push_back(
+            std::declval<typename C::value_type const&>()))>::type> : std::true_type {};
+
+        template <typename C, typename T>
+        void append(C& c, T const& value, std::true_type) {
+            c.push_back(value);
+        }
+
+        template <typename C, typename T>
+        void append(C& c, T const& value, std::false_type) {
+            c.add(value);
+        }
+
+        template <typename C, typename T>
+        void append(C& c, T const& value) {
+            append(c, value, has_push_back<C>());
+        }
+
+        // Moves the values of 'from' to the back of 'c', leaving 'from' empty.
+        // DynArray moves values bitwise, so its values are only relocated.
+        template <typename C>
+        void appendAll(C& c, C& from, std::true_type) {
+            c.insert(c.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+            from.clear();
+        }
+
+        template <typename C>
+        void appendAll(C& c, C& from, std::false_type) {
+            c.append(from.data(), from.size());
+            from.resize(0);
+        }
+
+        template <typename C>
+        void appendAll(C& c, C& from) {
+            appendAll(c, from, has_push_back<C>());
+        }
+    }
+
+    template <typename T>
+    class ArraySource {
+    public:
+        typedef T value_type;
+
+        // Can be cut into ranges which run on their own, see parallelCollect
+        static constexpr const bool sliceable = true;
+
+        ArraySource(const T* values, size_t len) : data(values), n(len) {}
+
+        size_t size() const noexcept {
+            return n;
+        }
+
+        ArraySource slice(size_t begin, size_t end) const noexcept {
+            return ArraySource(data + begin, end - begin);
+        }
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            for (size_t i = 0; i < n; ++i) {
+                if (!sink(data[i])) return false;
+            }
+
+            return true;
+        }
+
+    private:
+        const T* data;
+        size_t n;
+    };
+
+    template <typename List>
+    class DoublyListSource {
+    public:
+        typedef typename std::decay<decltype(std::declval<List const&>().fd_iter().extract().fromJust())>::type value_type;
+
+        static constexpr const bool sliceable = false;
+
+        explicit DoublyListSource(List const& l) : list(&l) {}
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            for (auto it = list->fd_iter(); !it.exhausted(); it.step_forward()) {
+                if (!sink(it.extract().fromJust())) return false;
+            }
+
+            return true;
+        }
+
+    private:
+        List const* list;
+    };
+
+    template <typename List>
+    class SinglyListSource {
+    public:
+        typedef typename std::decay<decltype(std::declval<List const&>().iter().extract().fromJust())>::type value_type;
+
+        static constexpr const bool sliceable = false;
+
+        explicit SinglyListSource(List const& l) : list(&l) {}
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            for (auto it = list->iter(); !it.exhausted(); it.step()) {
+                if (!sink(it.extract().fromJust())) return false;
+            }
+
+            return true;
+        }
+
+    private:
+        List const* list;
+    };
+
+    template <typename Container>
+    class DrainSource {
+    public:
+        typedef typename std::decay<decltype(std::declval<Container&>().poll().fromJust())>::type value_type;
+
+        static constexpr const bool sliceable = false;
+
+        explicit DrainSource(Container& c) : container(&c) {}
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            while (true) {
+                auto next = container->poll();
+                if (next.isNothing()) return true;
+                if (!sink(next.fromJust())) return false;
+            }
+        }
+
+    private:
+        Container* container;
+    };
+
+    template <typename Source, typename Fn>
+    class MapSource {
+    public:
+        typedef functional_detail::result_t<Fn, typename Source::value_type const&> value_type;
+
+        static constexpr const bool sliceable = Source::sliceable;
+
+        MapSource(Source s, Fn fn) : source(std::move(s)), f(std::move(fn)) {}
+
+        size_t size() const noexcept {
+            return source.size();
+        }
+
+        MapSource slice(size_t begin, size_t end) const {
+            return MapSource(source.slice(begin, end), f);
+        }
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            return source.forEach([&](typename Source::value_type const& value) {
+                return sink(f(value));
+            });
+        }
+
+    private:
+        Source source;
+        Fn f;
+    };
+
+    template <typename Source, typename Predicate>
+    class FilterSource {
+    public:
+        typedef typename Source::value_type value_type;
+
+        static constexpr const bool sliceable = Source::sliceable;
+
+        FilterSource(Source s, Predicate predicate) : source(std::move(s)), p(std::move(predicate)) {}
+
+        size_t size() const noexcept {
+            return source.size();
+        }
+
+        FilterSource slice(size_t begin, size_t end) const {
+            return FilterSource(source.slice(begin, end), p);
+        }
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            return source.forEach([&](value_type const& value) {
+                return p(value) ? sink(value) : true;
+            });
+        }
+
+    private:
+        Source source;
+        Predicate p;
+    };
+
+    // The first k values depend on everything before them, so this can not be
+    // sliced
+    template <typename Source>
+    class TakeSource {
+    public:
+        typedef typename Source::value_type value_type;
+
+        static constexpr const bool sliceable = false;
+
+        TakeSource(Source s, size_t count) : source(std::move(s)), k(count) {}
+
+        template <typename Sink>
+        bool forEach(Sink&& sink) const {
+            if (!k) return false;
+
+            size_t left = k;
+            return source.forEach([&](value_type const& value) {
+                return sink(value) && --left;
+            });
+        }
+
+    private:
+        Source source;
+        size_t k;
+    };
+
+    template <typename Source>
+    class View {
+    public:
+        typedef typename Source::value_type value_type;
+
+        explicit View(Source s) : source(std::move(s)) {}
+
+        Source const& get() const noexcept {
+            return source;
+        }
+
+    private:
+        Source source;
+    };
+
+    template <typename C>
+    View<ArraySource<typename std::decay<decltype(*std::declval<C const&>().data())>::type>>
+    view(C const& c, std::true_type, std::false_type, std::false_type) {
+        typedef typename std::decay<decltype(*c.data())>::type T;
+        return View<ArraySource<T>>(ArraySource<T>(c.data(), c.size()));
+    }
+
+    template <typename C>
+    View<DoublyListSource<C>> view(C const& c, std::false_type, std::true_type, std::false_type) {
+        return View<DoublyListSource<C>>(DoublyListSource<C>(c));
+    }
+
+    template <typename C>
+    View<SinglyListSource<C>> view(C const& c, std::false_type, std::false_type, std::true_type) {
+        return View<SinglyListSource<C>>(SinglyListSource<C>(c));
+    }
+
+    template <typename C>
+    auto view(C const& c) -> decltype(view(c, detail::has_data<C>(), detail::has_fd_iter<C>(), detail::has_iter<C>())) {
+        return view(c, detail::has_data<C>(), detail::has_fd_iter<C>(), detail::has_iter<C>());
+    }
+
+    template <typename T>
+    View<ArraySource<T>> view(const T* values, size_t n) {
+        return View<ArraySource<T>>(ArraySource<T>(values, n));
+    }
+
+    template <typename C>
+    View<DrainSource<C>> drain(C& c) {
+        return View<DrainSource<C>>(DrainSource<C>(c));
+    }
+
+    // ---- Stages
+
+    template <typename Fn>
+    struct MapStage {
+        Fn f;
+    };
+
+    template <typename Predicate>
+    struct FilterStage {
+        Predicate p;
+    };
+
+    struct TakeStage {
+        size_t k;
+    };
+
+    template <template <typename...> class C>
+    struct CollectStage {};
+
+    template <template <typename...> class C>
+    struct ParallelCollectStage {
+        unsigned threads;
+    };
+
+    template <typename Fn>
+    MapStage<typename std::decay<Fn>::type> map(Fn&& f) {
+        return {std::forward<Fn>(f)};
+    }
+
+    template <typename Predicate>
+    FilterStage<typename std::decay<Predicate>::type> filter(Predicate&& p) {
+        return {std::forward<Predicate>(p)};
+    }
+
+    inline TakeStage take(size_t k) noexcept {
+        return {k};
+    }
+
+    template <template <typename...> class C = DynArray>
+    CollectStage<C> collect() noexcept {
+        return {};
+    }
+
+    // Cuts the source into one range per thread, runs the pipeline over each
+    // of them into a container of its own reserved for the whole range, then
+    // moves these into the first one in order. Only for array sources with map
+    // and filter stages.
+    template <template <typename...> class C = DynArray>
+    ParallelCollectStage<C> parallelCollect(unsigned threads = non_std::hardware_threads()) noexcept {
+        return {threads};
+    }
+
+    template <typename Source, typename Fn>
+    View<MapSource<Source, Fn>> operator|(View<Source> const& v, MapStage<Fn> const& stage) {
+        return View<MapSource<Source, Fn>>(MapSource<Source, Fn>(v.get(), stage.f));
+    }
+
+    template <typename Source, typename Predicate>
+    View<FilterSource<Source, Predicate>> operator|(View<Source> const& v, FilterStage<Predicate> const& stage) {
+        return View<FilterSource<Source, Predicate>>(FilterSource<Source, Predicate>(v.get(), stage.p));
+    }
+
+    template <typename Source>
+    View<TakeSource<Source>> operator|(View<Source> const& v, TakeStage const& stage) {
+        return View<TakeSource<Source>>(TakeSource<Source>(v.get(), stage.k));
+    }
+
+    template <typename Source, template <typename...> class C>
+    C<typename Source::value_type> operator|(View<Source> const& v, CollectStage<C> const&) {
+        typedef typename Source::value_type T;
+
+        C<T> result;
+        v.get().forEach([&](T const& value) {
+            detail::append(result, value);
+            return true;
+        });
+
+        return result;
+    }
+
+    template <typename Source, template <typename...> class C>
+    C<typename Source::value_type> operator|(View<Source> const& v, ParallelCollectStage<C> const& stage) {
+        static_assert(Source::sliceable, "parallelCollect needs an array source with only map and filter stages");
+        typedef typename Source::value_type T;
+
+        Source const& source = v.get();
+        size_t n = source.size();
+        unsigned chunks = stage.threads ? stage.threads : 1;
+
+        auto parts = non_std::make_unique<C<T>[]>(chunks);
+
+        non_std::parallel_for(0, chunks, chunks, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                C<T>& part = parts[c];
+                size_t first = n * c / chunks, last = n * (c + 1) / chunks;
+
+                // Map and filter never yield more values than they are given
+                part.reserve(last - first);
+                source.slice(first, last).forEach([&](T const& value) {
+                    detail::append(part, value);
+                    return true;
+                });
+            }
+        });
+
+        size_t total = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            total += parts[c].size();
+        }
+
+        C<T> result(std::move(parts[0]));
+        result.reserve(total);
+        for (size_t c = 1; c < chunks; ++c) {
+            detail::appendAll(result, parts[c]);
+        }
+
+        return result;
+    }
+}
+
+/*#include <chrono>
+#include "../3LinkedLists/DoublyLinkedList.hpp"
+#include "../5Queues/Queue.hpp"
+#include "../6PriorityQueues/MinPQ.hpp"
+
+using namespace pipeline;
+
+template <typename Fn>
+void bench(const char* name, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = fn();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << seconds * 1e3 << "ms (" << sink << ")" << std::endl;
+}
+
+int main(void) {
+    auto square = [](long x) { return x * x; };
+    auto odd = [](long x) { return x % 2 != 0; };
+
+    DoublyLinkedList<long> list;
+    Queue<long> queue;
+    MinPQ<long> pq;
+    for (long x : {7, 3, 8, 1, 5, 4}) {
+        list.addLast(x);
+        queue.offer(x);
+        pq.offer(x);
+    }
+
+    std::cout << (view(list) | map(square) | filter(odd) | collect<DynArray>()) << std::endl; // [49, 9, 1, 25]
+    std::cout << (drain(pq) | take(3) | collect<DynArray>()) << " " << pq.size() << std::endl; // [1, 3, 4] 3
+    std::cout << (drain(queue) | filter(odd) | take(2) | collect<DynArray>()) << std::endl;   // [7, 3]
+
+    const size_t n = 1 << 24;
+    DynArray<long> values(n);
+    for (size_t i = 0; i < n; ++i) values.add((long)(i * 2654435761u % 1000003));
+
+    auto scale = [](long x) { return 3 * x + 1; };
+    auto even = [](long x) { return x % 2 == 0; };
+    auto half = [](long x) { return x / 2; };
+
+    bench("plain loop", [&]() {
+        DynArray<long> out;
+        for (size_t i = 0; i < n; ++i) {
+            long x = scale(values.data()[i]);
+            if (even(x)) out.add(half(x));
+        }
+
+        return out.size();
+    });
+
+    // One container per stage, as chains were written before
+    bench("eager stages", [&]() {
+        DynArray<long> scaled = fmap_(scale, values);
+        DynArray<long> kept;
+        for (size_t i = 0; i < scaled.size(); ++i) {
+            if (even(scaled.data()[i])) kept.add(scaled.data()[i]);
+        }
+
+        return fmap_(half, std::move(kept)).size();
+    });
+
+    bench("pipeline", [&]() {
+        return (view(values) | map(scale) | filter(even) | map(half) | collect<DynArray>()).size();
+    });
+
+    bench("pipeline, parallelCollect", [&]() {
+        return (view(values) | map(scale) | filter(even) | map(half) | parallelCollect<DynArray>()).size();
+    });
+
+    bench("pipeline, take(10)", [&]() {
+        return (view(values) | map(scale) | filter(even) | take(10) | collect<DynArray>()).size();
+    });
+
+    return 0;
+}*/
@@ -0,0 +1,343 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "NonSTD.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define SNAPSHOT_MMAP 1
+#endif
+
+namespace non_std {
+    // ---- Binary snapshots of built structures
+    //
+    // A snapshot file is a 64 byte header, a table of up to MAX_SECTIONS
+    // sections, then the sections themselves, each starting on a 64 byte
+    // boundary. Loading maps the file, so that structures can serve queries
+    // straight from their sections without copying or rebuilding anything.
+    // The byte order tag is written in native order: snapshots only load on
+    // machines of the same endianness, which zero copy requires anyway.
+
+    enum class SnapshotKind : uint32_t {
+        DYN_ARRAY = 1,
+        SPARSE_TABLE = 2,
+        UNION_FIND = 3,
+        DYNAMIC_UNION_FIND = 4
+    };
+
+    // When the checksum of a loaded snapshot is computed
+    enum class SnapshotCheck {
+        NOW,        // Before load returns, which throws on a mismatch
+        LAZY,       // On the first call to verify()
+        BACKGROUND  // On a thread started by load, verify() waits for it
+    };
+
+    namespace snapshot_detail {
+        static constexpr const char MAGIC[8] = {'D', 'S', 'A', 'S', 'N', 'A', 'P', '\0'};
+        static constexpr const uint32_t VERSION = 1;
+        static constexpr const uint32_t ORDER_TAG = 0x01020304;
+        static constexpr const size_t ALIGNMENT = 64;
+        static constexpr const size_t MAX_SECTIONS = 8;
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint32_t kind;
+            uint32_t valueSize;
+            uint64_t sections;
+            uint64_t checksum;
+            uint64_t reserved[3];
+        };
+
+        struct Section {
+            uint64_t offset;
+            uint64_t bytes;
+        };
+
+        static_assert(sizeof(Header) == ALIGNMENT, "Header must fill one block");
+
+        static constexpr const size_t DATA_START =
+            (sizeof(Header) + MAX_SECTIONS * sizeof(Section) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+        // FNV-1a over 64-bit words, continuing from 'hash'
+        inline uint64_t checksum(const void* data, size_t bytes, uint64_t hash) noexcept {
+            const uint64_t PRIME = 0x100000001b3ULL;
+            const unsigned char* p = (const unsigned char*)data;
+
+            for (; bytes >= 8; bytes -= 8, p += 8) {
+                uint64_t word;
+                memcpy(&word, p, 8);
+                hash = (hash ^ word) * PRIME;
+            }
+
+            for (; bytes; --bytes, ++p) {
+                hash = (hash ^ *p) * PRIME;
+            }
+
+            return hash;
+        }
+
+        static constexpr const uint64_t CHECKSUM_SEED = 0xcbf29ce484222325ULL;
+    }
+
+    // Writes the sections of one structure, in the order they are added
+    class SnapshotWriter {
+    public:
+        SnapshotWriter(std::string const& path, SnapshotKind kind, uint32_t valueSize) {
+            file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                throw std::runtime_error("Unable to create snapshot " + path);
+            }
+
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, snapshot_detail::MAGIC, sizeof(header.magic));
+            header.version = snapshot_detail::VERSION;
+            header.byteOrder = snapshot_detail::ORDER_TAG;
+            header.kind = (uint32_t)kind;
+            header.valueSize = valueSize;
+
+            memset(table, 0, sizeof(table));
+            pad(snapshot_detail::DATA_START);
+        }
+
+        virtual ~SnapshotWriter() noexcept {
+            if (file != nullptr) std::fclose(file);
+        }
+
+        SnapshotWriter(SnapshotWriter const&) = delete;
+        SnapshotWriter& operator=(SnapshotWriter const&) = delete;
+
+        void section(const void* data, size_t bytes) {
+            if (header.sections == snapshot_detail::MAX_SECTIONS) {
+                throw std::logic_error("Too many snapshot sections");
+            }
+
+            pad((position + snapshot_detail::ALIGNMENT - 1) / snapshot_detail::ALIGNMENT * snapshot_detail::ALIGNMENT);
+
+            table[header.sections].offset = position;
+            table[header.sections].bytes = bytes;
+            ++header.sections;
+
+            write(data, bytes);
+            hash = snapshot_detail::checksum(data, bytes, hash);
+        }
+
+        // Write the header and section table, the snapshot is complete after this
+        void close() {
+            header.checksum = hash;
+
+            if (std::fseek(file, 0, SEEK_SET) ||
+                std::fwrite(&header, sizeof(header), 1, file) != 1 ||
+                std::fwrite(table, sizeof(table), 1, file) != 1 ||
+                std::fclose(file)) {
+
+                file = nullptr;
+                throw std::runtime_error("Unable to write snapshot");
+            }
+
+            file = nullptr;
+        }
+
+    private:
+        void write(const void* data, size_t bytes) {
+            if (bytes && std::fwrite(data, 1, bytes, file) != bytes) {
+                throw std::runtime_error("Unable to write snapshot");
+            }
+
+            position += bytes;
+        }
+
+        void pad(size_t to) {
+            static const char zeros[snapshot_detail::ALIGNMENT] = {0};
+            while (position < to) {
+                size_t len = to - position < sizeof(zeros) ? to - position : sizeof(zeros);
+                write(zeros, len);
+            }
+        }
+
+        std::FILE* file = nullptr;
+
+        size_t position = 0;
+
+        uint64_t hash = snapshot_detail::CHECKSUM_SEED;
+
+        snapshot_detail::Header header;
+        snapshot_detail::Section table[snapshot_detail::MAX_SECTIONS];
+    };
+
+    // A snapshot file mapped into memory. The mapping is private: pages which
+    // a structure writes to (union find path compression) are copied on write
+    // and never reach the file.
+    class Snapshot {
+    public:
+        Snapshot(std::string const& path, SnapshotKind kind, uint32_t valueSize,
+                 SnapshotCheck check = SnapshotCheck::LAZY) {
+            map(path);
+
+            const unsigned char* base = mapping.base;
+            size_t bytes = mapping.bytes;
+
+            if (bytes < snapshot_detail::DATA_START) {
+                throw std::runtime_error("Not a snapshot: " + path);
+            }
+
+            memcpy(&header, base, sizeof(header));
+            memcpy(table, base + sizeof(header), sizeof(table));
+
+            if (memcmp(header.magic, snapshot_detail::MAGIC, sizeof(header.magic))) {
+                throw std::runtime_error("Not a snapshot: " + path);
+            }
+
+            if (header.byteOrder != snapshot_detail::ORDER_TAG) {
+                throw std::runtime_error("Snapshot was written with a different byte order");
+            }
+
+            if (header.version != snapshot_detail::VERSION) {
+                throw std::runtime_error("Unsupported snapshot version");
+            }
+
+            if (header.kind != (uint32_t)kind || header.valueSize != valueSize) {
+                throw std::runtime_error("Snapshot holds a different structure");
+            }
+
+            if (header.sections > snapshot_detail::MAX_SECTIONS) {
+                throw std::runtime_error("Corrupt snapshot section table");
+            }
+
+            for (size_t i = 0; i < header.sections; ++i) {
+                if (table[i].offset > bytes || table[i].bytes > bytes - table[i].offset) {
+                    throw std::runtime_error("Corrupt snapshot section table");
+                }
+            }
+
+            std::launch policy = check == SnapshotCheck::BACKGROUND ? std::launch::async : std::launch::deferred;
+            checked = std::async(policy, [this]() { return computeChecksum() == header.checksum; }).share();
+
+            if (check == SnapshotCheck::NOW && !verify()) {
+                throw std::runtime_error("Snapshot checksum mismatch: " + path);
+            }
+        }
+
+        virtual ~Snapshot() noexcept {
+            // A background check may still be reading the mapping
+            if (checked.valid()) checked.wait();
+        }
+
+        Snapshot(Snapshot const&) = delete;
+        Snapshot& operator=(Snapshot const&) = delete;
+
+        // Whether or not the checksum matches, computed at most once
+        bool verify() const {
+            return checked.get();
+        }
+
+        size_t sections() const noexcept {
+            return header.sections;
+        }
+
+        // Section i as an array of 'count' values of type U
+        template <typename U>
+        U* section(size_t i, size_t count) const {
+            if (i >= header.sections || table[i].bytes != sizeof(U) * count) {
+                throw std::runtime_error("Snapshot section does not match the structure");
+            }
+
+            return (U*)(mapping.base + table[i].offset);
+        }
+
+        // Number of values of type U in section i
+        template <typename U>
+        size_t count(size_t i) const {
+            if (i >= header.sections || table[i].bytes % sizeof(U)) {
+                throw std::runtime_error("Snapshot section does not match the structure");
+            }
+
+            return table[i].bytes / sizeof(U);
+        }
+
+    private:
+        void map(std::string const& path) {
+            #ifdef SNAPSHOT_MMAP
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Unable to open snapshot " + path);
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) || !info.st_size) {
+                ::close(fd);
+                throw std::runtime_error("Unable to open snapshot " + path);
+            }
+
+            size_t bytes = (size_t)info.st_size;
+            void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+
+            if (mapped == MAP_FAILED) {
+                throw std::runtime_error("Unable to map snapshot " + path);
+            }
+
+            mapping.base = (unsigned char*)mapped;
+            mapping.bytes = bytes;
+            #else
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (file == nullptr) {
+                throw std::runtime_error("Unable to open snapshot " + path);
+            }
+
+            std::fseek(file, 0, SEEK_END);
+            long size = std::ftell(file);
+            std::fseek(file, 0, SEEK_SET);
+
+            mapping.bytes = size > 0 ? (size_t)size : 0;
+            mapping.base = (unsigned char*)non_std::aligned_malloc(mapping.bytes ? mapping.bytes : 1, snapshot_detail::ALIGNMENT);
+
+            bool complete = std::fread(mapping.base, 1, mapping.bytes, file) == mapping.bytes;
+            std::fclose(file);
+
+            if (!complete) {
+                throw std::runtime_error("Unable to read snapshot " + path);
+            }
+            #endif
+        }
+
+        uint64_t computeChecksum() const noexcept {
+            uint64_t hash = snapshot_detail::CHECKSUM_SEED;
+            for (size_t i = 0; i < header.sections; ++i) {
+                hash = snapshot_detail::checksum(mapping.base + table[i].offset, table[i].bytes, hash);
+            }
+
+            return hash;
+        }
+
+        // Releases the file contents even if the constructor throws
+        struct Mapping {
+            unsigned char* base = nullptr;
+            size_t bytes = 0;
+
+            ~Mapping() noexcept {
+                #ifdef SNAPSHOT_MMAP
+                if (base != nullptr) munmap(base, bytes);
+                #else
+                non_std::aligned_free(base);
+                #endif
+            }
+        };
+
+        Mapping mapping;
+
+        snapshot_detail::Header header;
+        snapshot_detail::Section table[snapshot_detail::MAX_SECTIONS];
+
+        std::shared_future<bool> checked;
+    };
+}